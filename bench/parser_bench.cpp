@@ -0,0 +1,239 @@
+// Throughput benchmark for HttpParser
+// Replays the captures in bench/corpus/ (browser GETs, form and chunked
+// uploads, pipelined bursts) through one keep-alive parser, the way
+// ConnectionManager drives it, under different recv() patterns:
+//   whole      - the full capture in one read
+//   recv-1024  - 1 KiB reads
+//   split-all  - two reads, split at every byte boundary of every capture
+//   byte       - one byte per read (worst case for partial-line handling)
+//   cold       - whole reads, but a fresh parser per capture (new connection)
+// Reports requests/sec, MB/sec and heap allocations per request.
+// Build & run: make bench-parser [CORPUS=dir]
+
+#include "http/HttpParser.hpp"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <new>
+#include <cstdlib>
+#include <dirent.h>
+#include <sys/time.h>
+
+// Every allocation in the process goes through here, so the parser's
+// per-request cost shows up as a plain counter
+static size_t g_allocations = 0;
+
+void *operator new(size_t size) throw(std::bad_alloc)
+{
+	++g_allocations;
+	void *p = std::malloc(size ? size : 1);
+	if (!p)
+		throw std::bad_alloc();
+	return p;
+}
+
+void *operator new[](size_t size) throw(std::bad_alloc)
+{
+	return operator new(size);
+}
+
+void operator delete(void *p) throw()
+{
+	std::free(p);
+}
+
+void operator delete[](void *p) throw()
+{
+	std::free(p);
+}
+
+namespace
+{
+	struct Capture
+	{
+		std::string name;
+		std::string data;
+	};
+
+	struct Stats
+	{
+		size_t requests;
+		size_t bytes;
+		size_t errors;
+		size_t checksum;
+
+		Stats() : requests(0), bytes(0), errors(0), checksum(0) {}
+	};
+
+	bool loadCorpus(const std::string &dir, std::vector<Capture> &corpus)
+	{
+		DIR *d = opendir(dir.c_str());
+		if (!d)
+			return false;
+		struct dirent *entry;
+		while ((entry = readdir(d)) != NULL)
+		{
+			std::string name(entry->d_name);
+			if (name.size() < 6 || name.compare(name.size() - 5, 5, ".http") != 0)
+				continue;
+			std::ifstream file((dir + "/" + name).c_str(), std::ios::binary);
+			std::ostringstream content;
+			content << file.rdbuf();
+			Capture capture;
+			capture.name = name;
+			capture.data = content.str();
+			corpus.push_back(capture);
+		}
+		closedir(d);
+		return !corpus.empty();
+	}
+
+	// Run the parser as far as the buffered bytes allow, counting finished requests
+	void drain(HttpParser &parser, Stats &stats)
+	{
+		while (true)
+		{
+			if (parser.hasError())
+			{
+				++stats.errors;
+				parser.reset();
+				return;
+			}
+			if (parser.headersComplete())
+			{
+				parser.resume(); // No routing here: accept every body
+				continue;
+			}
+			if (!parser.isComplete())
+				return;
+
+			// Touch what a handler would read, so lazy work is not skipped
+			const HttpRequest &request = parser.getRequest();
+			stats.checksum += request.getPath().size() + request.getHeader(HDR_HOST).size() + request.getBody().size();
+			++stats.requests;
+			parser.startNextRequest();
+		}
+	}
+
+	void feed(HttpParser &parser, const std::string &data, size_t chunk, Stats &stats)
+	{
+		for (size_t off = 0; off < data.size(); off += chunk)
+		{
+			size_t n = data.size() - off < chunk ? data.size() - off : chunk;
+			parser.parse(data.data() + off, n);
+			drain(parser, stats);
+		}
+		stats.bytes += data.size();
+	}
+
+	void feedSplit(HttpParser &parser, const std::string &data, size_t at, Stats &stats)
+	{
+		parser.parse(data.data(), at);
+		drain(parser, stats);
+		parser.parse(data.data() + at, data.size() - at);
+		drain(parser, stats);
+		stats.bytes += data.size();
+	}
+
+	double seconds()
+	{
+		struct timeval tv;
+		gettimeofday(&tv, NULL);
+		return static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec) / 1e6;
+	}
+
+	void report(const char *name, const Stats &stats, size_t expected, double elapsed, size_t allocs)
+	{
+		double perRequest = stats.requests ? static_cast<double>(allocs) / static_cast<double>(stats.requests) : 0.0;
+		std::cout << "  " << std::left << std::setw(10) << name << std::right
+				  << std::setw(10) << stats.requests << " req "
+				  << std::fixed << std::setprecision(0) << std::setw(11) << stats.requests / elapsed << " req/s "
+				  << std::setprecision(1) << std::setw(8) << stats.bytes / elapsed / (1024.0 * 1024.0) << " MB/s "
+				  << std::setprecision(2) << std::setw(6) << perRequest << " allocs/req";
+		if (stats.errors || stats.requests != expected)
+			std::cout << "  MISMATCH (expected " << expected << ", errors " << stats.errors << ")";
+		std::cout << std::endl;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	std::string dir = argc > 1 ? argv[1] : "bench/corpus";
+	std::vector<Capture> corpus;
+	if (!loadCorpus(dir, corpus))
+	{
+		std::cerr << "No .http captures found in " << dir << std::endl;
+		return 1;
+	}
+	Logger::setMinLevel(Logger::LEVEL_OFF);
+
+	// Reference pass: how many requests each capture holds
+	HttpParser parser;
+	std::vector<size_t> perCapture;
+	size_t corpusBytes = 0;
+	size_t perPass = 0;
+	for (size_t i = 0; i < corpus.size(); ++i)
+	{
+		Stats stats;
+		feed(parser, corpus[i].data, corpus[i].data.size(), stats);
+		if (stats.errors || stats.requests == 0)
+		{
+			std::cerr << corpus[i].name << ": does not parse as complete requests" << std::endl;
+			return 1;
+		}
+		perCapture.push_back(stats.requests);
+		corpusBytes += corpus[i].data.size();
+		perPass += stats.requests;
+	}
+	std::cout << "Corpus: " << corpus.size() << " captures, " << perPass << " requests, "
+			  << corpusBytes << " bytes" << std::endl;
+
+	const size_t chunks[] = {0, 1024, 1};
+	const char *names[] = {"whole", "recv-1024", "byte"};
+	const size_t passes[] = {20000, 20000, 200};
+	for (size_t s = 0; s < 3; ++s)
+	{
+		Stats stats;
+		size_t allocs = g_allocations;
+		double start = seconds();
+		for (size_t p = 0; p < passes[s]; ++p)
+		{
+			for (size_t i = 0; i < corpus.size(); ++i)
+				feed(parser, corpus[i].data, chunks[s] ? chunks[s] : corpus[i].data.size(), stats);
+		}
+		report(names[s], stats, perPass * passes[s], seconds() - start, g_allocations - allocs);
+	}
+
+	Stats stats;
+	size_t expected = 0;
+	size_t allocs = g_allocations;
+	double start = seconds();
+	for (size_t i = 0; i < corpus.size(); ++i)
+	{
+		for (size_t at = 1; at < corpus[i].data.size(); ++at)
+			feedSplit(parser, corpus[i].data, at, stats);
+		expected += perCapture[i] * (corpus[i].data.size() - 1);
+	}
+	report("split-all", stats, expected, seconds() - start, g_allocations - allocs);
+
+	Stats cold;
+	allocs = g_allocations;
+	start = seconds();
+	for (size_t p = 0; p < 20000; ++p)
+	{
+		for (size_t i = 0; i < corpus.size(); ++i)
+		{
+			HttpParser fresh;
+			feed(fresh, corpus[i].data, corpus[i].data.size(), cold);
+		}
+	}
+	report("cold", cold, perPass * 20000, seconds() - start, g_allocations - allocs);
+	stats.checksum += cold.checksum;
+
+	volatile size_t sink = stats.checksum;
+	(void)sink;
+	return 0;
+}
@@ -0,0 +1,101 @@
+// libFuzzer entry point for HttpParser
+// Each input is parsed twice on one keep-alive parser: in a single read and
+// split in two at an input-derived offset, reading every field of each
+// request that completes. Seed it with bench/corpus/.
+// Build & run: make fuzz-parser (clang), then ./bench/parser_fuzz bench/corpus
+// Without libFuzzer, make fuzz-parser-replay builds a driver that replays files.
+
+#include "http/HttpParser.hpp"
+#include <stdint.h>
+#include <string>
+
+namespace
+{
+	size_t drain(HttpParser &parser)
+	{
+		size_t sum = 0;
+		while (!parser.hasError())
+		{
+			if (parser.headersComplete())
+			{
+				parser.resume();
+				continue;
+			}
+			if (!parser.isComplete())
+				return sum;
+
+			HttpRequest &request = parser.getRequest();
+			sum += request.getUri().size() + request.getPath().size() + request.getQuery().size();
+			sum += request.getCookie("SESSIONID").size() + request.getBody().size();
+			for (size_t i = 0; i < request.getQueryParamCount(); ++i)
+				sum += request.getQueryParamName(i).size() + request.getQueryParamValue(i).size();
+			for (size_t i = 0; i < request.getHeaderCount(); ++i)
+				sum += request.getHeaderName(i).size() + request.getHeaderValue(i).size();
+			parser.startNextRequest();
+		}
+		parser.getErrorMessage();
+		return sum;
+	}
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	static bool quiet = false;
+	if (!quiet)
+	{
+		Logger::setMinLevel(Logger::LEVEL_OFF);
+		quiet = true;
+	}
+
+	const char *bytes = reinterpret_cast<const char *>(data);
+	HttpParser parser;
+	parser.parse(bytes, size);
+	drain(parser);
+
+	parser.reset();
+	size_t at = size ? data[0] % size : 0;
+	parser.parse(bytes, at);
+	drain(parser);
+	parser.parse(bytes + at, size - at);
+	drain(parser);
+	return 0;
+}
+
+#ifndef WEBSERV_LIBFUZZER
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <dirent.h>
+
+// Replay driver: runs every file (or every file in a directory) once
+static void replay(const std::string &path, size_t &count)
+{
+	DIR *d = opendir(path.c_str());
+	if (d)
+	{
+		struct dirent *entry;
+		while ((entry = readdir(d)) != NULL)
+		{
+			if (entry->d_name[0] != '.')
+				replay(path + "/" + entry->d_name, count);
+		}
+		closedir(d);
+		return;
+	}
+	std::ifstream file(path.c_str(), std::ios::binary);
+	std::ostringstream content;
+	content << file.rdbuf();
+	std::string input = content.str();
+	LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(input.data()), input.size());
+	++count;
+}
+
+int main(int argc, char **argv)
+{
+	size_t count = 0;
+	for (int i = 1; i < argc; ++i)
+		replay(argv[i], count);
+	std::cout << "Replayed " << count << " inputs" << std::endl;
+	return 0;
+}
+#endif
@@ -0,0 +1,98 @@
+// Microbenchmark for the HttpScanner kernels
+// Walks a realistic browser header block line by line, the same way
+// HttpParser::nextLine() and ParseHeadersState do, once per implementation.
+// Build & run: make bench-scanner
+
+#include "http/HttpScanner.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <ctime>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#endif
+
+namespace
+{
+	const char *kHeaderBlock =
+		"GET /assets/app.3f9c2b.js?v=20261019 HTTP/1.1\r\n"
+		"Host: www.example.com\r\n"
+		"Connection: keep-alive\r\n"
+		"sec-ch-ua: \"Chromium\";v=\"128\", \"Not;A=Brand\";v=\"24\", \"Google Chrome\";v=\"128\"\r\n"
+		"sec-ch-ua-mobile: ?0\r\n"
+		"User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/128.0.0.0 Safari/537.36\r\n"
+		"sec-ch-ua-platform: \"Linux\"\r\n"
+		"Accept: */*\r\n"
+		"Sec-Fetch-Site: same-origin\r\n"
+		"Sec-Fetch-Mode: no-cors\r\n"
+		"Sec-Fetch-Dest: script\r\n"
+		"Referer: https://www.example.com/dashboard/overview\r\n"
+		"Accept-Encoding: gzip, deflate, br, zstd\r\n"
+		"Accept-Language: en-US,en;q=0.9,fr;q=0.8\r\n"
+		"Cookie: SESSIONID=Qx8v0cT1u3kPz9LmN2aB4dF6gH8jK0lM; theme=dark; _ga=GA1.1.123456789.1700000000\r\n"
+		"If-None-Match: W/\"1e240-65f1a2b3\"\r\n"
+		"\r\n";
+
+	// Same work the parser does per request: find each line end, then the ':' in it
+	size_t scanBlock(const char *data, size_t length)
+	{
+		size_t pos = 0;
+		size_t checksum = 0;
+		while (pos < length)
+		{
+			size_t end = pos + HttpScanner::findLineEnd(data + pos, length - pos);
+			if (end >= length)
+				break;
+			checksum += HttpScanner::findChar(data + pos, end - pos, ':');
+			pos = end + 2;
+		}
+		return checksum;
+	}
+
+	unsigned long long ticks()
+	{
+#ifdef HAVE_RDTSC
+		return __rdtsc();
+#else
+		return static_cast<unsigned long long>(std::clock());
+#endif
+	}
+}
+
+int main()
+{
+	const std::string block(kHeaderBlock);
+	const size_t iterations = 2000000;
+	const HttpScanner::Impl best = HttpScanner::getBestImpl();
+
+	std::cout << "Header block: " << block.size() << " bytes, " << iterations << " iterations" << std::endl;
+#ifdef HAVE_RDTSC
+	std::cout << "Unit: bytes per TSC cycle (higher is better)" << std::endl;
+#else
+	std::cout << "Unit: bytes per clock() tick (no TSC on this platform)" << std::endl;
+#endif
+
+	for (int i = HttpScanner::IMPL_SCALAR; i <= best; ++i)
+	{
+		HttpScanner::Impl impl = static_cast<HttpScanner::Impl>(i);
+		HttpScanner::forceImpl(impl);
+
+		volatile size_t sink = 0;
+		for (size_t w = 0; w < 10000; ++w) // warm up
+			sink += scanBlock(block.data(), block.size());
+
+		unsigned long long start = ticks();
+		for (size_t n = 0; n < iterations; ++n)
+			sink += scanBlock(block.data(), block.size());
+		unsigned long long elapsed = ticks() - start;
+
+		double bytes = static_cast<double>(block.size()) * iterations;
+		std::cout << "  " << std::setw(6) << HttpScanner::getImplName(impl) << ": "
+				  << std::fixed << std::setprecision(2) << bytes / static_cast<double>(elapsed)
+				  << " bytes/cycle" << std::endl;
+	}
+	HttpScanner::forceImpl(best);
+	return 0;
+}
@@ -2,11 +2,14 @@
 #define BASEMETHODHANDLER_HPP
 
 #include "app/IMethodHandler.hpp"
-#include "app/CgiExecutor.hpp"
+#include "app/CgiTask.hpp"
 #include "utils/StatusCodes.hpp"
+#include "utils/OpenFileCache.hpp"
 #include "utils/defines.hpp"
 #include "utils/Logger.hpp"
+#include "utils/utils.hpp"
 #include <cstdlib>
+#include <cstring>
 #include <sstream>
 #include <string>
 
@@ -20,9 +23,30 @@ public:
     // virtual std::string getName() const = 0;
 
 protected:
-    // Shared CGI logic
-    bool isCgiRequest(const std::string &path, const LocationConfig &config);
-    HttpResponse executeCgi(const std::string &path, const LocationConfig &config);
+    // Shared CGI logic (interpreter from LocationConfig::findCgiInterpreter)
+    HttpResponse executeCgi(const std::string &path, const std::string &interpreter);
+
+    // try_files: the first candidate that exists (a directory for one ending in '/'), else the
+    // fallback URI; both resolved under rootDir. 0 with filePath / info set (info.error if the
+    // fallback is missing too), or the status of an "=code" fallback
+    int resolveTryFiles(const std::string &uri, const LocationConfig &location, const std::string &rootDir,
+                        std::string &filePath, FileInfo &info);
+
+    // 404 / 403 / 500 for a failed OpenFileCache lookup
+    HttpResponse fileErrorResponse(const FileInfo &info, const std::string &path);
+
+    // Validators of a file: weak ETag from inode/size/mtime, and Last-Modified
+    static std::string makeETag(const FileInfo &info);
+    void addValidators(HttpResponse &response, const FileInfo &info);
+
+    // Conditional GET/HEAD: If-None-Match, else If-Modified-Since, says the client's copy is current
+    bool isNotModified(const HttpRequest &request, const FileInfo &info);
+    HttpResponse notModifiedResponse(const FileInfo &info);
+
+    // gzip_static / brotli_static: switch filePath and info to an accepted file.br / file.gz
+    // Returns the Content-Encoding to send, NULL when the plain file is served
+    const char *selectPrecompressed(const HttpRequest &request, const LocationConfig &location,
+                                    std::string &filePath, FileInfo &info);
 };
 
 #endif
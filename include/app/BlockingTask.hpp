@@ -0,0 +1,29 @@
+#ifndef BLOCKINGTASK_HPP
+#define BLOCKINGTASK_HPP
+
+#include "app/PendingResponse.hpp"
+#include "http/HttpResponse.hpp"
+
+// BlockingTask: a PendingResponse whose work is blocking disk I/O
+// A handler that would block on the filesystem (writing a file, unlinking one,
+// reading a directory) returns one instead. start() hands it to the ThreadPool,
+// where a worker calls run(); complete() then runs back on the loop and gives the
+// real response. When the pool is off or full, both run inline.
+// run() only makes syscalls on what the task owns: no Logger, no caches, nothing
+// shared with the loop. Logging and cache invalidation belong in complete().
+class BlockingTask : public PendingResponse
+{
+public:
+	virtual ~BlockingTask() {}
+
+	// On a worker thread
+	virtual void run() = 0;
+
+	// On the event loop, once run() has returned
+	virtual HttpResponse complete() = 0;
+
+	void start(int clientFd, AsyncContext &context);
+	bool cancel(int clientFd, AsyncContext &context);
+};
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef CGITASK_HPP
+#define CGITASK_HPP
+
+#include "app/PendingResponse.hpp"
+#include "utils/StatusCodes.hpp"
+#include "utils/defines.hpp"
+#include "utils/Logger.hpp"
+#include <string>
+
+// CgiTask: a PendingResponse answered by a CGI script
+// start() spawns the script; the loop then feeds it the request body and reads
+// its output through the pipes. Its exit, or the timeout, completes the request.
+class CgiTask : public PendingResponse
+{
+public:
+	CgiTask(const std::string &script, const std::string &interpreter);
+
+	void start(int clientFd, AsyncContext &context);
+	bool cancel(int clientFd, AsyncContext &context);
+
+private:
+	std::string _script;
+	std::string _interpreter;
+};
+
+#endif
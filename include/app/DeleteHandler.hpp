@@ -2,16 +2,9 @@
 #define DELETEHANDLER_HPP
 
 #include "app/IMethodHandler.hpp"
+#include "app/FileTasks.hpp"
 #include "utils/Logger.hpp"
-#include "utils/FileHandler.hpp"
-#include "utils/StatusCodes.hpp"
 #include "utils/defines.hpp"
-#include "utils/utils.hpp"
-#include <cerrno>
-#include <cstring>
-#include <unistd.h>
-#include <fcntl.h>
-#include <cstdio>
 
 class DeleteHandler : public IMethodHandler
 {
@@ -20,7 +13,7 @@ public:
     ~DeleteHandler() {}
 
     HttpResponse handle(
-        const HttpRequest &request,
+        HttpRequest &request,
         const LocationConfig &location);
 
     std::string getName() const { return "DeleteHandler"; }
@@ -0,0 +1,88 @@
+#ifndef FILETASKS_HPP
+#define FILETASKS_HPP
+
+#include "app/BlockingTask.hpp"
+#include "utils/RootDirectories.hpp"
+#include "utils/OpenFileCache.hpp"
+#include "utils/FileHandler.hpp"
+#include "utils/StatusCodes.hpp"
+#include "utils/defines.hpp"
+#include "utils/Logger.hpp"
+#include "utils/utils.hpp"
+#include <sys/stat.h>
+#include <dirent.h>
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <string>
+
+// FileTasks: the BlockingTasks behind PUT, DELETE, uploads and autoindex
+// Each one copies what it needs from the request up front: the client (and
+// its request) may be gone by the time a worker gets to the task.
+
+// PUT: replace the file at path with content, or create it
+class WriteFileTask : public BlockingTask
+{
+public:
+	// content is taken over (swapped), not copied
+	WriteFileTask(const std::string &path, std::string &content);
+
+	void run();
+	HttpResponse complete();
+
+private:
+	std::string _path;
+	std::string _content;
+	bool _created;
+	int _error; // errno of the failed write, 0 on success
+};
+
+// DELETE: remove the file (or empty directory) at path
+class RemoveFileTask : public BlockingTask
+{
+public:
+	explicit RemoveFileTask(const std::string &path);
+
+	void run();
+	HttpResponse complete();
+
+private:
+	std::string _path;
+	int _error;
+};
+
+// POST multipart/form-data: save one uploaded file into the upload directory
+class UploadTask : public BlockingTask
+{
+public:
+	// content is taken over (swapped), not copied
+	UploadTask(const std::string &filename, std::string &content, const std::string &uploadDir);
+
+	void run();
+	HttpResponse complete();
+
+private:
+	std::string _filename;
+	std::string _content;
+	std::string _path;
+	size_t _size;
+	int _error;
+};
+
+// autoindex: the listing of a directory, opened beneath its root
+class AutoIndexTask : public BlockingTask
+{
+public:
+	explicit AutoIndexTask(const std::string &dirPath);
+
+	void run();
+	HttpResponse complete();
+
+private:
+	std::string _dirPath;
+	std::string _html;
+	int _error;
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define GETHANDLER_HPP
 
 #include "app/BaseMethodHandler.hpp"
+#include "app/FileTasks.hpp"
 #include "utils/FileHandler.hpp"
 #include "utils/MimeTypes.hpp"
 #include "utils/utils.hpp"
@@ -10,6 +11,8 @@
 #include <iomanip>
 #include <sstream>
 #include <ctime>
+#include <vector>
+#include <algorithm>
 
 // GetHandler - Strategy for handling HTTP GET requests
 // Serves static files (HTML, CSS, images, etc.)
@@ -23,7 +26,7 @@ public:
 
 	// IMethodHandler interface implementation
 	HttpResponse handle(
-		const HttpRequest &request,
+		HttpRequest &request,
 		const LocationConfig &location);
 
 	std::string getName() const { return "GET"; }
@@ -31,11 +34,17 @@ public:
 private:
 	// Path handling and security
 	bool isPathSafe(const std::string &uri);
-	std::string normalizeUri(const std::string &uri);
 
 	// File serving
-	HttpResponse serveFile(const std::string &filePath, bool autoindex);
-	HttpResponse generateAutoIndex(const std::string &dirPath);
+	HttpResponse serveFile(const HttpRequest &request, const LocationConfig &location,
+						   std::string filePath, FileInfo &info);
+
+	// Range requests: (first, last) byte positions, both inclusive
+	typedef std::pair<size_t, size_t> ByteRange;
+	bool ifRangeMatches(const HttpRequest &request, const FileInfo &info);
+	int parseRanges(const StringView &header, size_t size, std::vector<ByteRange> &ranges);
+	void setMultipartRanges(HttpResponse &response, int fd, const std::string &filePath,
+							const FileInfo &info, const std::vector<ByteRange> &ranges);
 };
 
 #endif
\ No newline at end of file
@@ -1,7 +1,7 @@
 #ifndef HEADHANDLER_HPP
 #define HEADHANDLER_HPP
 
-#include "app/IMethodHandler.hpp"
+#include "app/BaseMethodHandler.hpp"
 #include "utils/FileHandler.hpp"
 #include "utils/MimeTypes.hpp"
 #include "utils/Logger.hpp"
@@ -9,14 +9,14 @@
 #include "utils/utils.hpp"
 #include "utils/defines.hpp"
 
-class HeadHandler : public IMethodHandler
+class HeadHandler : public BaseMethodHandler
 {
 public:
     HeadHandler() {}
     ~HeadHandler() {}
 
     HttpResponse handle(
-        const HttpRequest &request,
+        HttpRequest &request,
         const LocationConfig &location);
 
     std::string getName() const { return "HEAD"; }
@@ -3,6 +3,7 @@
 
 #include "http/HttpRequest.hpp"
 #include "http/HttpResponse.hpp"
+#include "app/PendingResponse.hpp"
 #include "config/LocationConfig.hpp"
 #include <string>
 
@@ -15,9 +16,11 @@ class IMethodHandler
 public:
 	virtual ~IMethodHandler() {}
 
-	// Handle the request and return a response
+	// Handle the request and return a response; one that can't be made right away
+	// (disk I/O, CGI) carries a PendingResponse that completes it later on the loop.
+	// The request isn't const so a handler can take its body over (PUT)
 	virtual HttpResponse handle(
-		const HttpRequest &request,
+		HttpRequest &request,
 		const LocationConfig &location) = 0;
 
 	// Get handler name for debugging
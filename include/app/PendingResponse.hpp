@@ -0,0 +1,49 @@
+#ifndef PENDINGRESPONSE_HPP
+#define PENDINGRESPONSE_HPP
+
+#include "http/HttpResponse.hpp"
+#include <string>
+
+class BlockingTask;
+
+// AsyncContext: what the event loop offers a PendingResponse (ConnectionManager implements it)
+// Every call is made on the loop thread.
+class AsyncContext
+{
+public:
+	virtual ~AsyncContext() {}
+
+	// Run task on a ThreadPool worker; false when the pool is off or full
+	virtual bool submit(int clientFd, BlockingTask *task) = 0;
+
+	// Spawn the CGI for the client's request, its pipes watched by the loop; false if it can't start
+	virtual bool startCgi(int clientFd, const std::string &script, const std::string &interpreter) = 0;
+	virtual void stopCgi(int clientFd) = 0;
+
+	// The final response: error page, location headers and gzip are applied, then it is sent.
+	// The PendingResponse is deleted here, so it is the last thing its caller does with it
+	virtual void complete(int clientFd, HttpResponse &response) = 0;
+};
+
+// PendingResponse: the continuation of a request whose response isn't ready when handle() returns
+// The handler sets one on the response it returns (HttpResponse::setPending). The
+// connection is then parked: nothing is read from it, its request stays as it is.
+// start() is called right away on the loop and kicks off the work (a worker
+// thread, a child process, later an upstream socket); whatever loop callback sees
+// the work finish calls AsyncContext::complete() exactly once. A large body is
+// still streamed: the final response may carry a file body (sendfile) or get
+// gzipped slice by slice.
+class PendingResponse
+{
+public:
+	virtual ~PendingResponse() {}
+
+	// The connection manager owns the object from here on
+	virtual void start(int clientFd, AsyncContext &context) = 0;
+
+	// The client went away first: stop the work. true: delete it now; false: it is still
+	// in use (by a worker) and is deleted when it comes back
+	virtual bool cancel(int clientFd, AsyncContext &context) = 0;
+};
+
+#endif
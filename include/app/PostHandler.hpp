@@ -2,6 +2,7 @@
 #define POSTHANDLER_HPP
 
 #include "app/BaseMethodHandler.hpp"
+#include "app/FileTasks.hpp"
 #include "utils/FileHandler.hpp"
 #include "utils/utils.hpp"
 #include <fstream>
@@ -20,7 +21,7 @@ public:
 
 	// IMethodHandler interface implementation
 	HttpResponse handle(
-		const HttpRequest &request,
+		HttpRequest &request,
 		const LocationConfig &location);
 
 	std::string getName() const { return "POST"; }
@@ -36,18 +37,6 @@ private:
 
 	// Handle regular form submission
 	HttpResponse handleFormSubmission(const HttpRequest &request);
-
-	// Save uploaded file
-	bool saveUploadedFile(
-		const std::string &filename,
-		const std::string &content,
-		const std::string &uploadDir);
-
-	// Generate upload response HTML
-	std::string generateUploadResponse(
-		const std::string &filename,
-		size_t fileSize,
-		bool success);
 };
 
 #endif
\ No newline at end of file
@@ -2,14 +2,9 @@
 #define PUTHANDLER_HPP
 
 #include "app/IMethodHandler.hpp"
-#include "utils/FileHandler.hpp"
-#include "utils/StatusCodes.hpp"
+#include "app/FileTasks.hpp"
 #include "utils/defines.hpp"
 #include "utils/Logger.hpp"
-#include "utils/utils.hpp"
-#include <cstring>
-#include <fstream>
-#include <cerrno>
 
 class PutHandler : public IMethodHandler
 {
@@ -18,7 +13,7 @@ public:
     ~PutHandler() {}
 
     HttpResponse handle(
-        const HttpRequest &request,
+        HttpRequest &request,
         const LocationConfig &location);
 
     std::string getName() const { return "PUT"; }
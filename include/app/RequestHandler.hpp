@@ -25,9 +25,18 @@ public:
 	RequestHandler();
 	~RequestHandler();
 
+	// Location rules that only need the headers (body size limit, allowed methods).
+	// Runs as soon as headers are parsed, with bodySize = the declared Content-Length.
+	// Returns false and fills `rejection` with the error response when the request is refused.
+	bool checkRequest(
+		const HttpRequest &request,
+		const LocationConfig &location,
+		size_t bodySize,
+		HttpResponse &rejection) const;
+
 	// Main request handler - delegates to registered strategy
 	HttpResponse handleRequest(
-		const HttpRequest &request,
+		HttpRequest &request,
 		const LocationConfig &location);
 
 private:
@@ -5,6 +5,7 @@
 #include "utils/Logger.hpp"
 #include "config/ServerConfig.hpp"
 #include "config/Token.hpp"
+#include <regex.h>
 #include <sstream>
 #include <vector>
 #include <string>
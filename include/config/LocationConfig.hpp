@@ -6,21 +6,57 @@
 #include <set>
 #include <map>
 
+class HttpResponse;
+
+// Response header added by add_header / expires, rendered once when the config is loaded
+struct ResponseHeader
+{
+	std::string name;
+	std::string value;
+	bool always; // Also on error responses (otherwise only 2xx / 3xx as in nginx)
+
+	ResponseHeader(const std::string &n, const std::string &v, bool a) : name(n), value(v), always(a) {}
+};
+
+// How a location's path is matched against the request path (nginx modifiers)
+enum LocationMatch
+{
+	MATCH_PREFIX,		   // location /path
+	MATCH_PREFIX_NO_REGEX, // location ^~ /path (when it is the longest prefix, regexes aren't tried)
+	MATCH_EXACT,		   // location = /path
+	MATCH_REGEX,		   // location ~ pattern
+	MATCH_REGEX_ICASE	   // location ~* pattern
+};
+
 // LocationConfig: Configuration for a location block
 // Represents a location directive in the config file
 class LocationConfig
 {
 private:
-	std::string path;								// Location path (e.g., "/", "/api", "/images")
+	std::string path;								// Location path (e.g., "/", "/api", "/images") or regex
+	LocationMatch match;							// Modifier the path was given with
 	std::string root;								// Root directory for this location (overrides server root)
 	std::vector<std::string> index;					// Index files for this location
 	std::set<std::string> allowedMethods;			// Allowed HTTP methods (GET, POST, PUT, DELETE, HEAD)
 	bool autoindex;									// Enable directory listing
+	bool gzipStatic;								// Serve file.gz next to file to gzip clients
+	bool brotliStatic;								// Serve file.br next to file to br clients
+	bool gzip;										// Compress responses on the fly for gzip clients
+	int gzipCompLevel;								// zlib level 1 (fast) .. 9 (small)
+	size_t gzipMinLength;							// Smaller bodies are sent as is
+	std::set<std::string> gzipTypes;				// MIME types to compress (text/html always, "*" any)
 	size_t clientMaxBodySize;						// Maximum request body size in bytes
 	std::string uploadStore;						// Directory for file uploads
 	std::map<std::string, std::string> cgiHandlers; // Map extension -> interpreter path
 	std::string redirect;							// Redirect URL (if any)
 	int redirectCode;								// Redirect status code (301, 302, etc.)
+	std::vector<ResponseHeader> expiresHeaders;		// Cache-Control / Expires from 'expires'
+	std::vector<ResponseHeader> addHeaders;			// From 'add_header', in config order
+	std::vector<std::string> tryFiles;				// try_files candidates, the fallback last (empty: off)
+	std::string successHeaders;						// Both rendered as "Name: value\r\n" lines for 2xx/3xx
+	std::string alwaysHeaders;						// ... and the 'always' ones for any other status
+
+	void renderResponseHeaders();
 
 public:
 	LocationConfig();
@@ -28,27 +64,50 @@ public:
 	~LocationConfig();
 
 	// Setters (Builder pattern)
+	LocationConfig &setMatch(LocationMatch match);
 	LocationConfig &setRoot(const std::string &root);
 	LocationConfig &addIndex(const std::string &indexFile);
 	LocationConfig &addAllowedMethod(const std::string &method);
 	LocationConfig &setAutoindex(bool enabled);
+	LocationConfig &setGzipStatic(bool enabled);
+	LocationConfig &setBrotliStatic(bool enabled);
+	LocationConfig &setGzip(bool enabled);
+	LocationConfig &setGzipCompLevel(int level);
+	LocationConfig &setGzipMinLength(size_t length);
+	LocationConfig &addGzipType(const std::string &mimeType);
 	LocationConfig &setClientMaxBodySize(size_t size);
 	LocationConfig &setUploadStore(const std::string &path);
 	LocationConfig &addCgiHandler(const std::string &extension, const std::string &interpreterPath);
 	LocationConfig &setRedirect(const std::string &url, int code = 301);
+	LocationConfig &setExpires(const std::vector<ResponseHeader> &headers);
+	LocationConfig &addResponseHeader(const std::string &name, const std::string &value, bool always);
+	LocationConfig &setTryFiles(const std::vector<std::string> &entries);
 
 	// Getters
 	std::string getPath() const;
+	LocationMatch getMatch() const;
+	bool isRegex() const;
 	std::string getRoot() const;
 	const std::vector<std::string> &getIndex() const;
 	bool isMethodAllowed(const std::string &method) const;
 	bool getAutoindex() const;
+	bool getGzipStatic() const;
+	bool getBrotliStatic() const;
+	bool getGzip() const;
+	int getGzipCompLevel() const;
+	size_t getGzipMinLength() const;
+	bool isGzipType(const std::string &contentType) const;
 	size_t getClientMaxBodySize() const;
 	std::string getUploadStore() const;
 	std::string getCgiPath(const std::string &extension) const;
+	const std::string *findCgiInterpreter(const std::string &filePath) const; // By extension, NULL if not CGI
 	std::string getRedirect() const;
 	int getRedirectCode() const;
 	bool hasRedirect() const;
+	const std::vector<std::string> &getTryFiles() const;
+
+	// Add the expires / add_header headers that apply to response's status (one copy of a pre-rendered block)
+	void applyResponseHeaders(HttpResponse &response) const;
 
 	// Utility
 	void clear();
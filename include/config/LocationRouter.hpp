@@ -0,0 +1,78 @@
+#ifndef LOCATIONROUTER_HPP
+#define LOCATIONROUTER_HPP
+
+#include "config/LocationConfig.hpp"
+#include "config/ServerConfig.hpp"
+#include "utils/StringView.hpp"
+#include "utils/Logger.hpp"
+#include "utils/RootDirectories.hpp"
+#include <regex.h>
+#include <string>
+#include <vector>
+#include <list>
+
+// LocationRouter: a server's locations compiled into a radix trie over their paths
+// Built once per server when it starts. Every location is copied once with the
+// server defaults (root, index, client_max_body_size) already merged in, so a
+// request gets a pointer to a finished LocationConfig: routing walks the trie
+// along the request path, O(path length) whatever the number of locations,
+// and allocates nothing.
+// Precedence follows nginx:
+// 1. "location = /path": the path itself only; found on the trie walk, which stops there
+// 2. the longest prefix location that ends on a path component ("/img" matches
+//    "/img" and "/img/a.png", not "/images"; "/" matches anything); if it is a
+//    "^~" one, regexes are not tried
+// 3. "location ~ re" / "~* re" (case-insensitive): the first that matches, in config order
+// 4. the prefix location from 2
+// Regexes are compiled once. With several of them, all are also joined into one
+// case-insensitive alternation that is tried first: a path none of them can match
+// (the common case for plain static files) costs one regexec instead of one per location.
+class LocationRouter
+{
+public:
+	explicit LocationRouter(const ServerConfig &config);
+	~LocationRouter();
+
+	// The location for path; the server's defaults ("/") when no location matches
+	const LocationConfig &route(const StringView &path) const;
+
+private:
+	struct Node
+	{
+		std::string label;			   // Path bytes consumed by the edge into this node
+		std::vector<Node *> children;  // First bytes of their labels are all different
+		const LocationConfig *location; // Prefix location whose path ends here (NULL: none)
+		const LocationConfig *exact;	// "=" location for exactly this path (NULL: none)
+		bool anyTail;					// Location "/": matches whatever follows
+		bool noRegex;					// location is "^~"
+
+		Node() : location(NULL), exact(NULL), anyTail(false), noRegex(false) {}
+	};
+
+	struct RegexRoute
+	{
+		regex_t regex;
+		const LocationConfig *location;
+	};
+
+	Node _root;
+	std::vector<RegexRoute> _regexes; // In config order
+	regex_t _prefilter;				  // All of _regexes as one alternation
+	bool _hasPrefilter;
+	std::list<LocationConfig> _locations; // Merged copies (a list: node pointers stay valid)
+	LocationConfig _fallback;
+
+	void merge(LocationConfig &location, const ServerConfig &config);
+	void insert(const std::string &path, const LocationConfig *location);
+	void addRegex(const LocationConfig *location);
+	void buildPrefilter();
+	static bool hasBackreference(const std::string &pattern);
+	const LocationConfig *matchRegex(const StringView &path) const;
+	static bool matches(const regex_t &regex, const StringView &path);
+	static void destroy(Node *node);
+
+	LocationRouter(const LocationRouter &);
+	LocationRouter &operator=(const LocationRouter &);
+};
+
+#endif
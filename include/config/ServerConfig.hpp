@@ -3,11 +3,24 @@
 
 #include "config/LocationConfig.hpp"
 #include "utils/defines.hpp"
+#include <ctime>
 #include <map>
 
 // Forward declaration
 class LocationConfig;
 
+// open_file_cache settings (max 0 = off)
+struct OpenFileCacheConfig
+{
+	size_t maxEntries; // open_file_cache max=<n>
+	time_t inactive;   // open_file_cache inactive=<time>
+	time_t valid;	   // open_file_cache_valid <time>
+	bool errors;	   // open_file_cache_errors on|off
+
+	OpenFileCacheConfig()
+		: maxEntries(0), inactive(OPEN_FILE_CACHE_INACTIVE), valid(OPEN_FILE_CACHE_VALID), errors(false) {}
+};
+
 // ServerConfig: Configuration for a virtual server
 // Represents a server block in the config file
 class ServerConfig
@@ -19,6 +32,13 @@ private:
 	std::string root;					   // Root directory for serving files
 	std::vector<std::string> index;		   // Default index files (e.g., ["index.html", "index.htm"])
 	size_t clientMaxBodySize;			   // Maximum request body size in bytes
+	size_t maxRequestLine;				   // Longest accepted request line (414 beyond)
+	size_t maxHeaderLine;				   // Longest accepted header line (431 beyond)
+	size_t maxHeaderCount;				   // Most header lines per request (431 beyond)
+	size_t maxHeaderSize;				   // Request line + headers total (431 beyond)
+	OpenFileCacheConfig openFileCache;	   // open_file_cache* directives
+	size_t staticCacheSize;				   // Response cache byte budget (0 = off)
+	size_t staticCacheMaxFile;			   // Largest file the response cache holds
 	std::map<int, std::string> errorPages; // Custom error pages (status code -> file path)
 	std::vector<LocationConfig> locations; // Location blocks for this server
 
@@ -33,6 +53,15 @@ public:
 	ServerConfig &setRoot(const std::string &root);
 	ServerConfig &addIndex(const std::string &indexFile);
 	ServerConfig &setClientMaxBodySize(size_t size);
+	ServerConfig &setMaxRequestLine(size_t size);
+	ServerConfig &setMaxHeaderLine(size_t size);
+	ServerConfig &setMaxHeaderCount(size_t count);
+	ServerConfig &setMaxHeaderSize(size_t size);
+	ServerConfig &setOpenFileCache(size_t maxEntries, time_t inactive);
+	ServerConfig &setOpenFileCacheValid(time_t valid);
+	ServerConfig &setOpenFileCacheErrors(bool enabled);
+	ServerConfig &setStaticCacheSize(size_t size);
+	ServerConfig &setStaticCacheMaxFile(size_t size);
 	ServerConfig &addErrorPage(int statusCode, const std::string &path);
 	ServerConfig &addLocation(const LocationConfig &location);
 
@@ -43,9 +72,16 @@ public:
 	std::string getRoot() const;
 	const std::vector<std::string> &getIndex() const;
 	size_t getClientMaxBodySize() const;
+	size_t getMaxRequestLine() const;
+	size_t getMaxHeaderLine() const;
+	size_t getMaxHeaderCount() const;
+	size_t getMaxHeaderSize() const;
+	const OpenFileCacheConfig &getOpenFileCache() const;
+	size_t getStaticCacheSize() const;
+	size_t getStaticCacheMaxFile() const;
 	std::string getErrorPage(int statusCode) const;
+	const std::map<int, std::string> &getErrorPages() const;
 	const std::vector<LocationConfig> &getLocations() const;
-	const LocationConfig *matchLocation(const std::string &uri) const;
 
 	// Utility
 	void clear();
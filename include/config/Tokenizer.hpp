@@ -9,7 +9,7 @@
 
 // Tokenizer (Lexer) for nginx-style config files
 // Breaks config file into tokens: words, braces, semicolons
-// Handles comments (#) and tracks line numbers
+// Handles comments (#), quoted values ("a, b" or 'a b') and tracks line numbers
 class Tokenizer
 {
 private:
@@ -19,6 +19,7 @@ private:
 	std::vector<Token> _tokens; // All tokens generated
 
 	Token readWord();
+	Token readQuoted();
 	Token readToken();
 
 public:
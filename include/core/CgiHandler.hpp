@@ -16,21 +16,29 @@
 #include <cstdlib>
 #include <map>
 
+// Where a CGI stands after an event on one of its pipes
+enum CgiProgress
+{
+    CGI_RUNNING, // Still going
+    CGI_DONE,    // Exited cleanly: the response is the script's output
+    CGI_FAILED   // Crashed or exited non-zero: the response is the server's 502 / 500
+};
+
 class CgiHandler
 {
 public:
     CgiHandler();
     ~CgiHandler();
 
-    // Start CGI process
-    void startCgi(ClientConnection *client, const HttpRequest &request, const HttpResponse &response, Poller &poller);
+    // Start the script for the client's request and watch its pipes; false if it can't run
+    bool startCgi(ClientConnection *client, const std::string &script, const std::string &interpreter, Poller &poller);
 
-    // Handle IO events
-    void handleCgiRead(int pipeFd, ClientConnection *client, Poller &poller);
-    void handleCgiWrite(int pipeFd, ClientConnection *client, Poller &poller);
+    // Handle IO events; once the CGI is over, response is what the client gets
+    CgiProgress handleCgiRead(int pipeFd, ClientConnection *client, Poller &poller, HttpResponse &response);
+    CgiProgress handleCgiWrite(int pipeFd, ClientConnection *client, Poller &poller, HttpResponse &response);
+    CgiProgress handleCgiHangup(int pipeFd, ClientConnection *client, Poller &poller, HttpResponse &response);
 
-    void handleTimeout(ClientConnection *client, Poller &poller);
-    void handleCgiHangup(int pipeFd, ClientConnection *client, Poller &poller);
+    HttpResponse handleTimeout(ClientConnection *client, Poller &poller);
     void cleanupCgi(ClientConnection *client, Poller &poller);
 
     // Map Management
@@ -38,7 +46,7 @@ public:
     bool hasCgiPipe(int pipeFd) const;
 
 private:
-    void processCgiResponse(ClientConnection *client);
+    HttpResponse processCgiResponse(ClientConnection *client);
     std::map<int, int> _pipeToClient; // pipeFd -> clientFd
 };
 
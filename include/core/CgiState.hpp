@@ -12,13 +12,14 @@ struct CgiState
     pid_t pid;
     int pipeIn[2];              // Parent -> Child (Write body here)
     int pipeOut[2];             // Child -> Parent (Read response here)
-    std::string requestBody;    // Body to write to CGI
+    const std::string *requestBody; // Body to write to CGI (owned by the client's parser until the CGI finishes)
+    size_t bodyWritten;             // Bytes of requestBody already written to the pipe
     std::string responseBuffer; // Output from CGI
     bool headersParsed;
     bool active;
     time_t startTime;
 
-    CgiState() : pid(-1), headersParsed(false), active(false), startTime(0)
+    CgiState() : pid(-1), requestBody(NULL), bodyWritten(0), headersParsed(false), active(false), startTime(0)
     {
         pipeIn[0] = -1;
         pipeIn[1] = -1;
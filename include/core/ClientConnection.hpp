@@ -2,9 +2,14 @@
 #define CLIENTCONNECTION_HPP
 
 #include "http/HttpParser.hpp"
+#include "config/LocationConfig.hpp"
 #include "core/CgiState.hpp"
+#include "core/GzipFilter.hpp"
 #include "utils/Logger.hpp"
 #include <unistd.h>
+#include <sys/sendfile.h>
+#include <algorithm>
+#include <deque>
 
 class ClientConnection
 {
@@ -12,8 +17,17 @@ private:
     int _fd;                  // socket fd for this client
     std::string _readBuffer;  // store data read from client
     std::string _writeBuffer; // store data to be sent to client
+    int _fileFd;              // file body sent after _writeBuffer drains (-1: none)
+    off_t _fileOffset;        // next file byte to send
+    size_t _fileRemaining;    // file bytes left to send
+    std::deque<FileSegment> _fileSegments; // further segments of the same file (multi-range)
+    std::string _fileTrailer;              // queued once the last segment is sent
+    GzipFilter *_gzip;        // on-the-fly compression of the body (NULL: sent as is)
+    std::string _gzipInput;   // in-memory body still to compress (when there's no file body)
+    size_t _gzipInputPos;
     bool _shouldClose;
     HttpParser _parser; // HTTP request parser
+    const LocationConfig *_location; // Location the current request was routed to (set once headers are in)
     CgiState _cgiState;
 
 public:
@@ -29,9 +43,27 @@ public:
     void appendToWriteBuffer(const std::string &data);
     void clearWriteBuffer();
 
+    // File body (takes ownership of fd); streamed with sendfile() after the write buffer
+    void setFileBody(int fd, off_t offset, size_t length);
+    void setFileSegments(const std::vector<FileSegment> &segments, const std::string &trailer);
+    bool hasFileBody() const;
+    ssize_t sendFileBody(); // Send the next part; closes the file once it is all sent
+                            // (a segment's headers / the trailer go to the write buffer first)
+    void closeFileBody();
+
+    // gzip body (takes ownership of filter): the file body if set, else body, compressed a slice
+    // at a time into the write buffer as it drains
+    void setGzipBody(GzipFilter *filter, const std::string &body);
+    bool hasGzipBody() const;
+    bool fillGzipBody(); // Queue the next compressed chunk(s); false on a read or zlib error
+
     // HTTP Parser access
     HttpParser &getParser();
 
+    // Routing result for the current request
+    void setLocation(const LocationConfig *location) { _location = location; }
+    const LocationConfig &getLocation() const { return *_location; }
+
     // CGI State
     CgiState &getCgiState() { return _cgiState; }
 };
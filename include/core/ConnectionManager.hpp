@@ -2,10 +2,15 @@
 #define CONNECTIONMANAGER_HPP
 
 #include "app/RequestHandler.hpp"
+#include "app/PendingResponse.hpp"
 #include "config/ServerConfig.hpp"
+#include "config/LocationRouter.hpp"
 #include "core/ClientConnection.hpp"
 #include "core/ServerSocket.hpp"
 #include "core/CgiHandler.hpp"
+#include "core/ResponseCache.hpp"
+#include "core/ErrorPageCache.hpp"
+#include "core/ThreadPool.hpp"
 #include "core/Poller.hpp"
 #include "utils/Logger.hpp"
 #include "utils/StatusCodes.hpp"
@@ -19,7 +24,8 @@
 class ConnectionManager
 {
 public:
-    ConnectionManager(RequestHandler &requestHandler, CgiHandler &cgiHandler);
+    ConnectionManager(RequestHandler &requestHandler, CgiHandler &cgiHandler, ResponseCache &responseCache,
+                      ErrorPageCache &errorPageCache, ThreadPool &threadPool);
     ~ConnectionManager();
 
     // Configuration
@@ -38,22 +44,56 @@ public:
 
     void checkCgiTimeouts(Poller &poller);
 
+    // Loop callbacks that complete pending responses
+    void handleTaskCompletions(Poller &poller);             // BlockingTasks a worker is done with
+    void handleCgiEvent(const PollEvent &ev, Poller &poller); // A CGI pipe is ready
+
 private:
+    // The AsyncContext handed to a PendingResponse: this manager and the loop's poller
+    class LoopContext : public AsyncContext
+    {
+    public:
+        LoopContext(ConnectionManager &manager, Poller &poller) : _manager(manager), _poller(poller) {}
+
+        bool submit(int clientFd, BlockingTask *task);
+        bool startCgi(int clientFd, const std::string &script, const std::string &interpreter);
+        void stopCgi(int clientFd);
+        void complete(int clientFd, HttpResponse &response);
+
+    private:
+        ConnectionManager &_manager;
+        Poller &_poller;
+    };
+    friend class LoopContext;
+
     std::map<int, ClientConnection *> _clients;
     std::map<int, int> _clientToServer;         // Map client FD to server FD
     std::map<int, ServerConfig> _serverConfigs; // serverFd -> config
+    std::map<int, LocationRouter *> _routers;   // serverFd -> its compiled locations
+    LocationRouter _defaultRouter;              // Built with the manager: roots are only registered at config time
+    std::map<int, PendingResponse *> _pending;  // clientFd -> continuation it is parked on
 
     RequestHandler &_requestHandler;
     CgiHandler &_cgiHandler;
+    ResponseCache &_responseCache;
+    ErrorPageCache &_errorPageCache;
+    ThreadPool &_threadPool;
 
     // Request processing helpers
     const ServerConfig &resolveConfig(int clientFd);
-    LocationConfig     resolveLocation(const HttpRequest &request, const ServerConfig &config);
+    const LocationRouter &resolveRouter(int clientFd);
+    void               handleParsed(int clientFd, ClientConnection *client, Poller &poller);
+    bool               routeRequest(int clientFd, ClientConnection *client, Poller &poller);
     void               processRequest(int clientFd, ClientConnection *client, Poller &poller);
+    void               finishRequest(int clientFd, ClientConnection *client, HttpResponse &response,
+                                     const std::string &cacheKey, Poller &poller, bool errorPages = true);
+    void               startPending(int clientFd, PendingResponse *pending, Poller &poller);
+    void               completePending(int clientFd, HttpResponse &response, Poller &poller, bool errorPages = true);
     void               processParseError(int clientFd, ClientConnection *client, Poller &poller);
+    bool               responseCacheKey(const HttpRequest &request, const LocationConfig &location, std::string &key);
 
-    void sendResponse(ClientConnection *client, HttpResponse &response, Poller &poller);
-    void applyCustomErrorPage(HttpResponse &response, const ServerConfig &config);
+    void sendResponse(ClientConnection *client, HttpResponse &response, Poller &poller, GzipFilter *gzip = NULL);
+    void applyCustomErrorPage(HttpResponse &response, int clientFd);
 };
 
 #endif
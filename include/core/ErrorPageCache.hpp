@@ -0,0 +1,63 @@
+#ifndef ERRORPAGECACHE_HPP
+#define ERRORPAGECACHE_HPP
+
+#include "config/ServerConfig.hpp"
+#include "core/Poller.hpp"
+#include "utils/FileHandler.hpp"
+#include "utils/MimeTypes.hpp"
+#include "utils/Logger.hpp"
+#include "utils/utils.hpp"
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <string>
+#include <map>
+
+// ErrorPageCache: the error_page files of every server, read once at startup
+// An error response takes its body and headers from memory: no path building,
+// no open file cache lookup, no fd. The directory of each page is watched with
+// inotify (the fd is registered in the Poller) and a changed page is read again.
+// Without inotify nothing is preloaded and error pages are served from disk.
+class ErrorPageCache
+{
+public:
+	struct Page
+	{
+		std::string path;		   // Full file path (root + error_page path)
+		std::string body;
+		std::string contentType;
+		std::string contentLength; // body.size(), already formatted
+		bool loaded;			   // False while the file is missing or unreadable
+		int wd;					   // inotify watch on the file's directory
+		std::string name;		   // File name inside that directory
+	};
+
+	ErrorPageCache();
+	~ErrorPageCache();
+
+	// Create the inotify fd and register it with poller
+	bool enable(Poller &poller);
+	int getFd() const; // inotify fd, -1 when disabled
+
+	// Read every error_page of the server listening on serverFd
+	void load(int serverFd, const ServerConfig &config);
+
+	// The preloaded page for code on serverFd, NULL if none is configured or it failed to load
+	const Page *find(int serverFd, int code) const;
+
+	// Drain inotify events and read the pages they touch again
+	void handleEvents();
+
+private:
+	int _inotifyFd;
+	std::map<std::string, Page> _pages;					 // Full path -> page (shared by servers)
+	std::map<int, std::map<int, const Page *> > _byServer; // serverFd -> status code -> page
+	std::map<std::string, int> _watches;				 // Watched directory -> wd
+
+	void read(Page &page);
+	int watchDirectory(const std::string &dir);
+
+	ErrorPageCache(const ErrorPageCache &);
+	ErrorPageCache &operator=(const ErrorPageCache &);
+};
+
+#endif
@@ -9,10 +9,12 @@
 #include "core/ServerSocket.hpp"
 #include "http/HttpRequest.hpp"
 #include "core/CgiHandler.hpp"
+#include "core/ThreadPool.hpp"
 #include "http/HttpResponse.hpp"
 #include "utils/StatusCodes.hpp"
 #include "utils/defines.hpp"
 #include "utils/Logger.hpp"
+#include "utils/OpenFileCache.hpp"
 #include <sys/socket.h>
 #include <sys/epoll.h>
 #include <sys/wait.h>
@@ -34,6 +36,9 @@ private:
     std::map<int, ServerSocket *> _servers;
     RequestHandler *_requestHandler; // Strategy pattern handler
     CgiHandler _cgiHandler;
+    ResponseCache _responseCache;
+    ErrorPageCache _errorPageCache;
+    ThreadPool _threadPool;
     ConnectionManager _connManager;
 
 public:
@@ -41,6 +46,7 @@ public:
     ~EventLoop();
 
     void addServer(ServerSocket *server, const ServerConfig &config);
+    bool enableResponseCache(size_t budget, size_t maxFileSize);
     void run();
     void stop();
 };
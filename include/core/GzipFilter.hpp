@@ -0,0 +1,58 @@
+#ifndef GZIPFILTER_HPP
+#define GZIPFILTER_HPP
+
+#include "config/LocationConfig.hpp"
+#include "http/HttpRequest.hpp"
+#include "http/HttpResponse.hpp"
+#include "utils/OpenFileCache.hpp"
+#include "utils/Logger.hpp"
+#include "utils/utils.hpp"
+#include "utils/defines.hpp"
+#include <zlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+// GzipFilter: on-the-fly gzip between a handler's response and the client's write buffer
+// The connection feeds the body in GZIP_CHUNK_SIZE slices as the socket drains, so a
+// large file or CGI output is never compressed in one go inside the event loop. The
+// length isn't known up front: output is framed with chunked transfer coding.
+// A static file's complete gzipped body is handed to the open file cache when done,
+// and later requests for it are answered from there with a plain Content-Length.
+class GzipFilter
+{
+public:
+	~GzipFilter();
+
+	// Decide for a ready response (gzip on, client accepts it, type and length match)
+	// - NULL: sent as is, or its body was replaced with a cached gzipped copy
+	// - a filter: headers are rewritten (Content-Encoding, chunked), the caller streams the body through it
+	// HEAD is negotiated the same way and gets GET's headers, but never a filter
+	static GzipFilter *apply(HttpResponse &response, const HttpRequest &request, const LocationConfig &location);
+
+	// Compress the next slice of the body and append it to out as one chunk;
+	// finish ends the stream (gzip trailer and last-chunk). False on a zlib error
+	bool write(const char *data, size_t length, bool finish, std::string &out);
+	bool isFinished() const;
+
+private:
+	z_stream _stream;
+	bool _finished;
+	int _level;
+
+	// Static file source: the gzipped body is collected for the open file cache
+	std::string _cachePath;
+	FileInfo _cacheInfo;
+	std::string _compressed;
+
+	GzipFilter(int level);
+	bool init();
+
+	GzipFilter(const GzipFilter &);
+	GzipFilter &operator=(const GzipFilter &);
+};
+
+#endif
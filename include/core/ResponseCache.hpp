@@ -0,0 +1,75 @@
+#ifndef RESPONSECACHE_HPP
+#define RESPONSECACHE_HPP
+
+#include "http/HttpResponse.hpp"
+#include "core/Poller.hpp"
+#include "utils/Logger.hpp"
+#include "utils/utils.hpp"
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <climits>
+#include <string>
+#include <list>
+#include <map>
+
+// ResponseCache: fully serialized responses (head + body) of small static files
+// A hit is appended to the client's write buffer as is: no GetHandler, no file
+// access, no HttpResponse::build(). Keyed by root + request path, and only
+// stored when that path is the served file itself: a directory answered with
+// its index file is not cached, since the entry only follows the file it holds.
+// - bounded by a byte budget, least recently used entries are evicted first
+// - the directory of every cached file is watched with inotify; the inotify fd
+//   is registered in the Poller, so an edit under root drops the entry at once
+class ResponseCache
+{
+public:
+	ResponseCache();
+	~ResponseCache();
+
+	// Start caching (budget 0 = disabled); registers the inotify fd with poller
+	bool enable(size_t budget, size_t maxFileSize, Poller &poller);
+	bool isEnabled() const;
+	int getFd() const; // inotify fd, -1 when disabled
+
+	// Append the cached response for key to out (only its head for HEAD); false on miss
+	bool lookup(const std::string &key, bool headOnly, std::string &out);
+
+	// Cache a 200 response whose body is a file segment or made from one (small enough to fit)
+	// file is root + request path: a response served from any other file is not cached
+	void store(const std::string &key, const std::string &file, const HttpResponse &response);
+
+	// Drain inotify events and drop the entries they touch
+	void handleEvents();
+
+	void clear();
+
+private:
+	struct Entry
+	{
+		std::string key;
+		std::string response; // Serialized head (without Date/Server) + body
+		size_t statusLength;  // Bytes of response that are the status line (Date/Server go after it)
+		size_t headLength;	  // Bytes of response that are the head (HEAD hits)
+		int wd;				  // inotify watch on the file's directory
+		std::string name;	  // File name inside that directory
+		std::string path;	  // Full file path (to refresh the open file cache)
+	};
+	typedef std::list<Entry> EntryList;
+
+	int _inotifyFd;
+	size_t _budget;
+	size_t _maxFileSize;
+	size_t _used; // Bytes held by all entries
+	EntryList _entries; // Most recently used first
+	std::map<std::string, EntryList::iterator> _index;
+	std::map<std::string, int> _watches; // Watched directory -> wd
+
+	int watchDirectory(const std::string &dir);
+	void invalidate(int wd, const std::string &name);
+	void evict(EntryList::iterator it);
+
+	ResponseCache(const ResponseCache &);
+	ResponseCache &operator=(const ResponseCache &);
+};
+
+#endif
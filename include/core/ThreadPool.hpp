@@ -0,0 +1,60 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include "app/BlockingTask.hpp"
+#include "core/Poller.hpp"
+#include "utils/Logger.hpp"
+#include "utils/utils.hpp"
+#include <sys/eventfd.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <deque>
+#include <vector>
+
+// ThreadPool: a fixed set of worker threads running BlockingTasks
+// Tasks wait in a bounded queue. A finished one goes on a done list and the
+// eventfd is bumped, so the event loop picks completions up like any other fd
+// and calls complete() on its own thread. Workers block every signal: SIGINT
+// is always handled by the loop.
+class ThreadPool
+{
+public:
+	struct Job
+	{
+		int clientFd;
+		BlockingTask *task;
+	};
+
+	ThreadPool();
+	~ThreadPool();
+
+	// Start threads workers, with at most maxQueue tasks waiting; false leaves the pool off
+	bool start(size_t threads, size_t maxQueue, Poller &poller);
+	int getFd() const; // -1 when not started
+
+	// Queue task for clientFd; false when the pool is off or the queue is full (the caller runs it)
+	bool submit(int clientFd, BlockingTask *task);
+
+	// Move the finished jobs into done; their tasks are the caller's to delete
+	void collect(std::vector<Job> &done);
+
+private:
+	pthread_mutex_t _mutex;
+	pthread_cond_t _cond;
+	std::vector<pthread_t> _threads;
+	std::deque<Job> _queue;
+	std::vector<Job> _done;
+	size_t _maxQueue;
+	bool _stopping;
+	int _eventFd;
+
+	static void *workerMain(void *arg);
+	void work();
+
+	ThreadPool(const ThreadPool &);
+	ThreadPool &operator=(const ThreadPool &);
+};
+
+#endif
@@ -7,6 +7,7 @@
 #include "core/EventLoop.hpp"
 #include "core/ServerSocket.hpp"
 #include "utils/MimeTypes.hpp"
+#include "utils/OpenFileCache.hpp"
 #include "utils/Logger.hpp"
 #include "utils/utils.hpp"
 #include "utils/defines.hpp"
@@ -41,6 +42,7 @@ private:
 
 	bool loadConfiguration();
 	bool setupServers();
+	void configureCaches();
 	void cleanup();
 
 	WebServer(const WebServer &);
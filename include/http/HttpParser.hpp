@@ -3,12 +3,10 @@
 
 #include "http/HttpRequest.hpp"
 #include "http/IParseState.hpp"
+#include "http/HttpScanner.hpp"
 #include "utils/Logger.hpp"
 #include "utils/defines.hpp"
 
-// Forward declarations
-class IParseState;
-
 // HttpParser: State Machine for parsing HTTP requests
 // Uses State Pattern for clean separation of parsing stages
 class HttpParser
@@ -19,6 +17,17 @@ public:
 
 	// Feed data to parser (can be called multiple times for chunked data)
 	void parse(const std::string &data);
+	void parse(const char *data, size_t length);
+
+	// Headers are parsed and the parser is paused before the body:
+	// the caller routes the request (and may lower the body limit), then calls resume()
+	bool headersComplete() const;
+	void resume();
+
+	// Body framing announced by the headers (valid once headersComplete())
+	bool expectsBody() const;
+	bool isChunked() const;
+	size_t getContentLength() const;
 
 	// Check parsing status
 	bool isComplete() const;
@@ -29,26 +38,68 @@ public:
 	HttpRequest &getRequest();
 	const HttpRequest &getRequest() const;
 
+	// Result of pulling one line out of the buffer
+	enum LineStatus
+	{
+		LINE_OK,		 // A complete CRLF-terminated line was sliced out
+		LINE_INCOMPLETE, // Need more data
+		LINE_INVALID,	 // Control character / bare CR or LF inside the line
+		LINE_TOO_LONG	 // Line (or the part received so far) exceeds the caller's limit
+	};
+
 	// Reset parser for reuse (e.g., for keep-alive connections)
 	void reset();
 
+	// Like reset(), but keep any bytes received after the completed request
+	// (pipelined requests) and start parsing them right away
+	void startNextRequest();
+
 	void setMaxBodySize(size_t size) { _maxBodySize = size; }
 	size_t getMaxBodySize() const { return _maxBodySize; }
 
+	// Request head limits, enforced as bytes arrive (defaults from defines.hpp)
+	void setHeaderLimits(size_t maxRequestLine, size_t maxHeaderLine, size_t maxHeaderCount, size_t maxHeaderSize);
+
 private:
 	HttpRequest _request;		// The request being built
-	IParseState *_currentState; // Current parsing state
-	std::string _buffer;		// Accumulated unparsed data
+	IParseState *_currentState; // Current parsing state (points at one of the members below)
+	std::string _buffer;		// Receive buffer: request line + headers stay in place, request slices point here
+	size_t _pos;				// Start of unconsumed data in _buffer
+	size_t _scanPos;			// Where the next CRLF search resumes (avoids rescanning partial lines)
 	size_t _maxBodySize;		// Max allowed body size
+	size_t _maxRequestLine;		// Max request line length (414 beyond)
+	size_t _maxHeaderLine;		// Max single header / chunk-size line length (431 beyond)
+	size_t _maxHeaderCount;		// Max number of header lines (431 beyond)
+	size_t _maxHeaderSize;		// Max request line + headers in bytes (431 beyond)
+	bool _headersComplete;		// Paused between headers and body, waiting for resume()
+	bool _chunked;				// Transfer-Encoding: chunked
+	size_t _contentLength;		// Content-Length (0 when chunked or absent)
 	bool _isComplete;			// Parsing completed successfully
 	bool _hasError;				// Parsing error occurred
 	std::string _errorMessage;	// Error description
 
+	// Preallocated states (flyweights): transitions just swap _currentState
+	ParseRequestLineState _requestLineState;
+	ParseHeadersState _headersState;
+	ParseBodyState _bodyState;
+	ParseChunkedBodyState _chunkedBodyState;
+	ParseCompleteState _completeState;
+	ParseErrorState _errorState;
+
+	void resetState();
+
 	// State transitions (called by state objects)
 	void setState(IParseState *newState);
 	void setComplete();
 	void setError(const std::string &message);
 
+	// Buffer cursor helpers for the states
+	LineStatus nextLine(HttpSlice &line, size_t maxLength); // Slice out the next CRLF-terminated line
+	size_t available() const;			// Unconsumed bytes after the cursor
+	const char *cursor() const;			// Pointer to the first unconsumed byte
+	void consumeBody(size_t length);	// Drop body bytes already copied out (keeps header slices intact)
+	void discardFrom(size_t offset);	// Drop framing bytes between offset and the cursor
+
 	// Allow states to access private members
 	// friend is used here to grant access to private members
 	// which means we don't have to expose setters publicly
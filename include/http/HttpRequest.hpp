@@ -2,7 +2,9 @@
 #define HTTPREQUEST_HPP
 
 #include <string>
+#include <vector>
 #include <map>
+#include "utils/StringView.hpp"
 
 // HTTP Methods
 enum HttpMethod
@@ -15,34 +17,135 @@ enum HttpMethod
 	HTTP_UNKNOWN
 };
 
+// Offset/length pair pointing into the raw request buffer owned by HttpParser
+// Offsets (not pointers) stay valid when the buffer grows and reallocates
+struct HttpSlice
+{
+	size_t offset;
+	size_t length;
+
+	HttpSlice() : offset(0), length(0) {}
+	HttpSlice(size_t off, size_t len) : offset(off), length(len) {}
+};
+
+// One decoded "name=value" pair of the query string, as slices of the
+// request's query scratch buffer
+struct HttpQueryParam
+{
+	HttpSlice name;
+	HttpSlice value;
+};
+
+// Headers the server itself looks at, interned while parsing so lookups
+// are an array index instead of a scan with string compares
+enum HttpHeaderId
+{
+	HDR_HOST,
+	HDR_CONTENT_LENGTH,
+	HDR_TRANSFER_ENCODING,
+	HDR_CONNECTION,
+	HDR_COOKIE,
+	HDR_CONTENT_TYPE,
+	HDR_EXPECT,
+	HDR_IF_NONE_MATCH,
+	HDR_RANGE,
+	HDR_ACCEPT_ENCODING,
+	HDR_IF_RANGE,
+	HDR_IF_MODIFIED_SINCE,
+	HDR_COUNT,
+	HDR_OTHER = HDR_COUNT
+};
+
+// One "Name: value" header line, both parts as slices of the raw buffer
+struct HttpHeaderField
+{
+	HttpSlice name;
+	HttpSlice value;
+	HttpHeaderId id;
+};
+
+// HttpRequest: the parsed view of a request
+// The request line and headers are not copied out of the receive buffer;
+// the parser records slices and strings are only built when a handler asks.
 class HttpRequest
 {
 private:
+	const std::string *raw;				  // Receive buffer the slices point into
 	HttpMethod method;
-	std::string uri;							// The Uniform Resource Identifier - the path requested
-	std::string version;						// 1.1
-	std::map<std::string, std::string> headers; // metadata about the request - like the Host, Content-Type, etc.
+	HttpSlice uri;						  // The Uniform Resource Identifier - the path requested
+	HttpSlice version;					  // 1.1
+	std::vector<HttpHeaderField> headers; // metadata about the request - like the Host, Content-Type, etc.
+	int knownHeaders[HDR_COUNT];		  // index into headers for each well-known id, -1 if absent
 	std::string body;
-	std::map<std::string, std::string> cookies;
+
+	// Request-target pieces, split once while parsing (parseTarget)
+	HttpSlice path;			 // uri up to '?' / '#' (still encoded)
+	HttpSlice query;		 // between '?' and '#'
+	bool pathDecoded;		 // path had escapes: decoded copy lives in decodedPath
+	std::string decodedPath; // reused across keep-alive requests, so no allocation once warm
+
+	// Derived fields, computed on first use and cached until clear()
+	mutable bool queryParsed;
+	mutable std::string queryScratch; // decoded names/values, packed back to back
+	mutable std::vector<HttpQueryParam> queryParams;
+	mutable bool cookiesParsed;
+	mutable std::map<std::string, std::string> cookies;
+
+	StringView view(const HttpSlice &slice) const;
+	int findHeader(const StringView &name) const;
+	void parseQuery() const;
+	void parseCookies() const;
 
 public:
 	HttpRequest();
 	~HttpRequest();
 
+	// Bind the buffer that slices refer to (done once by HttpParser)
+	void bindBuffer(const std::string *buffer);
+
 	HttpRequest &setMethod(HttpMethod method);
-	HttpRequest &setUri(const std::string &uri);
-	HttpRequest &setVersion(const std::string &version);
-	HttpRequest &addHeader(const std::string &key, const std::string &value);
-	HttpRequest &setBody(const std::string &body);
-	void parseCookies();
+	HttpRequest &setUri(const HttpSlice &uri);
+	HttpRequest &setVersion(const HttpSlice &version);
+	HttpRequest &addHeader(const HttpSlice &key, const HttpSlice &value);
+	HttpRequest &appendBody(const char *data, size_t length);
+	HttpRequest &swapBody(std::string &other); // Hands the body over without copying it
 
+	// Split the uri into path and query and percent-decode the path.
+	// Fails on a malformed escape, an encoded NUL, or a ".." path segment.
+	bool parseTarget();
+
+	// Accessors hand out views into the receive buffer or references to members;
+	// nothing is copied unless the caller asks for a std::string
 	HttpMethod getMethod() const;
-	std::string getMethodString() const;
-	std::string getUri() const;
-	std::string getHeader(const std::string &key) const;
-	const std::map<std::string, std::string> &getHeaders() const;
-	std::string getBody() const;
-	std::string getCookie(const std::string &key) const;
+	const char *getMethodString() const;
+	StringView getUri() const;
+	StringView getPath() const;	 // decoded uri path, without query string / fragment
+	StringView getQuery() const; // raw query string (without '?'), empty if none
+	StringView getVersion() const;
+
+	// Header lookups return views into the receive buffer (empty view if absent).
+	// Names compare case-insensitively; well-known names resolve in O(1).
+	StringView getHeader(HttpHeaderId id) const;
+	StringView getHeader(const StringView &name) const;
+	bool hasHeader(HttpHeaderId id) const;
+	const std::string &getBody() const;
+	size_t getBodySize() const;
+	const std::string &getCookie(const std::string &key) const; // Cookie header is parsed on the first call
+
+	// Decoded query parameters (query string is parsed on the first call)
+	StringView getQueryParam(const StringView &name) const; // first match, empty if absent
+	size_t getQueryParamCount() const;
+	StringView getQueryParamName(size_t index) const;
+	StringView getQueryParamValue(size_t index) const;
+
+	// Header iteration (in arrival order)
+	size_t getHeaderCount() const;
+	StringView getHeaderName(size_t index) const;
+	StringView getHeaderValue(size_t index) const;
+	HttpHeaderId getHeaderId(size_t index) const;
+
+	// Map a header name to its well-known id (HDR_OTHER if not interned)
+	static HttpHeaderId lookupHeaderId(const char *name, size_t length);
 
 	void clear();
 };
@@ -6,19 +6,45 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <sys/types.h>
+
+// Further part of a file body: in-memory bytes (multipart/byteranges part headers),
+// then bytes [offset, offset + length) of the same file
+class PendingResponse;
+
+struct FileSegment
+{
+    std::string before;
+    off_t offset;
+    size_t length;
+
+    FileSegment(const std::string &b, off_t o, size_t l) : before(b), offset(o), length(l) {}
+};
 
 class HttpResponse
 {
 private:
+    typedef std::pair<std::string, std::string> Header;
+
     int statusCode;
     std::string version;
     std::string reasonPhrase;
-    std::map<std::string, std::string> headers;
+    const char *_statusLine;     // Pre-rendered "HTTP/1.1 200 OK\r\n" from the status table (NULL: custom reason)
+    std::vector<Header> headers; // Few per response: a linear scan beats a map's node per header
+    std::string _headerFragment; // Pre-rendered "Name: value\r\n" lines (per-location headers)
     std::string body;
 
-    bool _isCgi;
-    std::string _cgiScriptPath;
-    std::string _cgiInterpreterPath;
+    // Static file body: (fd, offset, length) segment sent with sendfile() by the connection.
+    // The fd is not owned here; ClientConnection takes it over in sendResponse()
+    int _fileFd;
+    off_t _fileOffset;
+    size_t _fileLength;
+    std::string _filePath; // Where the segment comes from (response cache invalidation)
+    std::string _filePrefix;                // Sent before the first segment (multi-range part headers)
+    std::vector<FileSegment> _fileSegments; // Sent after the first segment (multi-range)
+    std::string _fileTrailer;               // Sent after the last one
+
+    PendingResponse *_pending; // Not ready yet: ConnectionManager takes it over and starts it
     std::vector<std::string> cookies;
 
 public:
@@ -27,18 +53,49 @@ public:
 
     HttpResponse &setStatus(int code, const std::string &reason);
     HttpResponse &addHeader(const std::string &key, const std::string &value);
+    HttpResponse &removeHeader(const std::string &key);
+    HttpResponse &addHeaderFragment(const std::string &fragment); // Pre-rendered header lines, copied as is
+    HttpResponse &addVary(const std::string &header); // Merged into an existing Vary
+    HttpResponse &setContentEncoding(const std::string &coding); // Also adds Vary: Accept-Encoding
+    HttpResponse &setChunked(); // Length unknown up front: Transfer-Encoding: chunked, no Content-Length
     HttpResponse &setBody(const std::string &body);
+    HttpResponse &setFileBody(int fd, off_t offset, size_t length, const std::string &path);
+    HttpResponse &setFilePath(const std::string &path); // File an in-memory body was made from
+    HttpResponse &setFilePrefix(const std::string &prefix);
+    HttpResponse &addFileSegment(const std::string &before, off_t offset, size_t length);
+    HttpResponse &setFileTrailer(const std::string &trailer);
     HttpResponse &addCookie(const std::string &key, const std::string &value, int maxAge = 0);
     std::string getHeader(const std::string &key) const;
     int getStatusCode() const;
+    const std::string &getBody() const;
+    bool isChunked() const;
+
+    // The real response comes later, from this continuation (see PendingResponse)
+    HttpResponse &setPending(PendingResponse *pending);
+    PendingResponse *getPending() const;
 
-    void setCgi(bool isCgi);
-    bool isCgi() const;
-    void setCgiInfo(const std::string &script, const std::string &interpreter);
-    std::string getCgiScriptPath() const;
-    std::string getCgiInterpreterPath() const;
+    bool hasFileBody() const;
+    int getFileFd() const;
+    off_t getFileOffset() const;
+    size_t getFileLength() const;
+    const std::string &getFilePath() const;
+    const std::string &getFilePrefix() const;
+    const std::vector<FileSegment> &getFileSegments() const;
+    const std::string &getFileTrailer() const;
 
+    // Status line and headers, up to the blank line, appended to out (a connection's write buffer:
+    // its capacity is reused, nothing is formatted). The Date/Server block is added unless withDate
+    // is false (the response cache stores heads without it and adds the current one on each hit)
+    void appendHead(std::string &out, bool withDate = true) const;
+    void appendTo(std::string &out) const; // Head + in-memory body (a file body is not included)
+    std::string buildHead(bool withDate = true) const;
     std::string build() const;
+
+    // "Date: <now>\r\nServer: webserv\r\n", re-rendered at most once a second
+    static const std::string &dateServerHeaders();
+
+    // Standard reason phrase of a status code ("Error" for one the server doesn't know)
+    static const char *reasonPhraseFor(int code);
 };
 
 #endif
\ No newline at end of file
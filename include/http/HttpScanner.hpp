@@ -0,0 +1,40 @@
+#ifndef HTTPSCANNER_HPP
+#define HTTPSCANNER_HPP
+
+#include <cstddef>
+
+// HttpScanner: byte-scanning kernels for the request parser
+// Each scan has a scalar version plus SSE2/AVX2 versions on x86; the best one
+// the CPU supports is picked once at startup (same idea as picohttpparser).
+// All functions return the index of the match, or `length` when there is none.
+class HttpScanner
+{
+public:
+	enum Impl
+	{
+		IMPL_SCALAR,
+		IMPL_SSE2,
+		IMPL_AVX2
+	};
+
+	// First byte that cannot appear inside a request/header line:
+	// control characters other than HTAB, and DEL. A well-formed line stops on its '\r'.
+	static size_t findLineEnd(const char *data, size_t length);
+
+	// First occurrence of `c` (used for the header ':' delimiter)
+	static size_t findChar(const char *data, size_t length, char c);
+
+	// First "\r\n" pair
+	static size_t findCRLF(const char *data, size_t length);
+
+	// Implementation selection (forceImpl is for benchmarks; it is clamped to what the CPU supports)
+	static Impl getImpl();
+	static Impl getBestImpl();
+	static void forceImpl(Impl impl);
+	static const char *getImplName(Impl impl);
+
+private:
+	HttpScanner();
+};
+
+#endif
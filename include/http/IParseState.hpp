@@ -1,7 +1,7 @@
 #ifndef IPARSESTATE_HPP
 #define IPARSESTATE_HPP
 
-#include "http/HttpParser.hpp"
+#include "http/HttpRequest.hpp"
 #include "utils/Logger.hpp"
 #include "utils/utils.hpp"
 #include <sstream>
@@ -15,6 +15,8 @@ class HttpParser;
 // The State Pattern allows the parser to change its behavior
 // Its one of the best ways to implement state machines.
 // Each concrete state handles one phase of HTTP parsing
+// States are flyweights: HttpParser owns one instance of each by value and
+// switches between them, so a parse never allocates for the state machine
 class IParseState
 {
 public:
@@ -26,7 +28,7 @@ public:
 	virtual void parse(HttpParser &parser) = 0;
 
 	// Get state name for debugging
-	virtual std::string getName() const = 0;
+	virtual const char *getName() const = 0;
 };
 
 // Concrete States
@@ -39,31 +41,38 @@ class ParseRequestLineState : public IParseState
 {
 public:
 	virtual void parse(HttpParser &parser);
-	virtual std::string getName() const
+	virtual const char *getName() const
 	{
 		return "ParseRequestLine";
 	}
 
 private:
-	bool parseRequestLine(HttpParser &parser, const std::string &line);
+	bool parseRequestLine(HttpParser &parser, const HttpSlice &line);
 };
 
 // State 2: Parse headers (Host: localhost, Content-Length: 100, etc.)
 // Example: "Host: localhost"
 // In this state, we read each header line, parse the key-value pairs,
-// and store them in the HttpRequest object's headers map.
+// and record them as slices in the HttpRequest object's header table.
 class ParseHeadersState : public IParseState
 {
 public:
+	ParseHeadersState();
+	void begin();						// Reset the header line counter for a new request
+	void startBody(HttpParser &parser); // Pick the body state once the request has been routed
+
 	virtual void parse(HttpParser &parser);
-	virtual std::string getName() const
+	virtual const char *getName() const
 	{
 		return "ParseHeaders";
 	}
 
 private:
-	bool parseHeaderLine(HttpParser &parser, const std::string &line);
+	bool parseHeaderLine(HttpParser &parser, const HttpSlice &line);
 	size_t getContentLength(HttpParser &parser);
+	void fail(HttpParser &parser, const std::string &message);
+
+	size_t _lineCount; // Header lines seen so far (bounded by the parser's header count limit)
 };
 
 // State 3: Parse body (POST/PUT data)
@@ -73,7 +82,7 @@ class ParseBodyState : public IParseState
 {
 public:
 	virtual void parse(HttpParser &parser);
-	virtual std::string getName() const
+	virtual const char *getName() const
 	{
 		return "ParseBody";
 	}
@@ -83,7 +92,10 @@ private:
 	size_t _bytesRead;
 
 public:
-	ParseBodyState(size_t contentLength);
+	ParseBodyState();
+
+	// Re-arm the state for a new body of the given length
+	void begin(size_t contentLength);
 };
 
 // State 3b: Parse chunked body (Transfer-Encoding: chunked)
@@ -93,7 +105,10 @@ class ParseChunkedBodyState : public IParseState
 public:
 	ParseChunkedBodyState();
 	virtual void parse(HttpParser &parser);
-	virtual std::string getName() const { return "ParseChunkedBody"; }
+
+	// Re-arm the state for a new chunked body
+	void begin();
+	virtual const char *getName() const { return "ParseChunkedBody"; }
 
 private:
 	enum ChunkState
@@ -114,7 +129,7 @@ class ParseCompleteState : public IParseState
 {
 public:
 	virtual void parse(HttpParser &parser);
-	virtual std::string getName() const
+	virtual const char *getName() const
 	{
 		return "ParseComplete";
 	}
@@ -126,7 +141,7 @@ class ParseErrorState : public IParseState
 {
 public:
 	virtual void parse(HttpParser &parser);
-	virtual std::string getName() const
+	virtual const char *getName() const
 	{
 		return "ParseError";
 	}
@@ -23,12 +23,23 @@ public:
 	static bool parseIndex(std::vector<Token> &tokens, size_t &pos, ServerConfig &server, std::string &error);
 	static bool parseClientMaxBodySize(std::vector<Token> &tokens, size_t &pos, ServerConfig &server, std::string &error);
 	static bool parseErrorPage(std::vector<Token> &tokens, size_t &pos, ServerConfig &server, std::string &error);
+	static bool parseLargeClientHeaderBuffers(std::vector<Token> &tokens, size_t &pos, ServerConfig &server, std::string &error);
+	static bool parseHeaderLimit(std::vector<Token> &tokens, size_t &pos, ServerConfig &server, std::string &error);
+	static bool parseOpenFileCache(std::vector<Token> &tokens, size_t &pos, ServerConfig &server, std::string &error);
+	static bool parseOpenFileCacheValid(std::vector<Token> &tokens, size_t &pos, ServerConfig &server, std::string &error);
+	static bool parseOpenFileCacheErrors(std::vector<Token> &tokens, size_t &pos, ServerConfig &server, std::string &error);
+	static bool parseStaticCache(std::vector<Token> &tokens, size_t &pos, ServerConfig &server, std::string &error);
 
 	// Location directive parsers
 	static bool parseAllowedMethods(std::vector<Token> &tokens, size_t &pos, LocationConfig &location, std::string &error);
 	static bool parseLocationRoot(std::vector<Token> &tokens, size_t &pos, LocationConfig &location, std::string &error);
 	static bool parseLocationIndex(std::vector<Token> &tokens, size_t &pos, LocationConfig &location, std::string &error);
 	static bool parseAutoindex(std::vector<Token> &tokens, size_t &pos, LocationConfig &location, std::string &error);
+	static bool parseStaticCompression(std::vector<Token> &tokens, size_t &pos, LocationConfig &location, std::string &error);
+	static bool parseGzip(std::vector<Token> &tokens, size_t &pos, LocationConfig &location, std::string &error);
+	static bool parseExpires(std::vector<Token> &tokens, size_t &pos, LocationConfig &location, std::string &error);
+	static bool parseAddHeader(std::vector<Token> &tokens, size_t &pos, LocationConfig &location, std::string &error);
+	static bool parseTryFiles(std::vector<Token> &tokens, size_t &pos, LocationConfig &location, std::string &error);
 	static bool parseClientMaxBodySize(std::vector<Token> &tokens, size_t &pos, LocationConfig &location, std::string &error);
 	static bool parseUploadStore(std::vector<Token> &tokens, size_t &pos, LocationConfig &location, std::string &error);
 	static bool parseCgiAssign(std::vector<Token> &tokens, size_t &pos, LocationConfig &location, std::string &error);
@@ -2,8 +2,10 @@
 #define ERRORPAGEGENERATOR_HPP
 
 #include "utils/FileHandler.hpp"
+#include <cstring>
 #include <sstream>
 #include <string>
+#include <vector>
 #include <map>
 
 class ErrorPageGenerator
@@ -19,16 +21,35 @@ public:
     void clearErrorPage(int statusCode);
     void clearAllErrorPages();
 
-    // Get error page content
-    std::string getErrorPage(int statusCode, const std::string &reason) const;
+    // Get error page content (rendered once per status code and reason, then copied)
+    const std::string &getErrorPage(int statusCode, const std::string &reason) const;
 
 private:
+    // A page template split at its placeholders: literal text, then what follows it
+    enum Placeholder
+    {
+        NONE,
+        STATUS_CODE,
+        REASON
+    };
+    struct Segment
+    {
+        std::string text;
+        Placeholder next;
+    };
+    typedef std::vector<Segment> Template;
+
     std::map<int, std::string> errorPages_;
+    Template defaultTemplate_; // Compiled once, at construction
+    mutable std::map<int, std::pair<std::string, std::string> > rendered_; // code -> (reason, page)
 
     // Private constructor for singleton
-    ErrorPageGenerator() {}
+    ErrorPageGenerator();
     ~ErrorPageGenerator() {}
 
+    static Template compile(const std::string &source);
+    static std::string render(const Template &page, const std::string &code, const std::string &reason);
+
     // Generate default error page HTML
     std::string generateDefaultPage() const;
 };
@@ -1,9 +1,11 @@
 #ifndef FILEHANDLER_HPP
 #define FILEHANDLER_HPP
 
+#include "utils/RootDirectories.hpp"
 #include <sys/stat.h>
-#include <fstream>
-#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
 #include <string>
 #include <ctime>
 
@@ -13,12 +15,20 @@ private:
     FileHandler();
     ~FileHandler();
 
+    static bool statPath(const std::string &path, struct stat &st);
+
 public:
     static bool fileExists(const std::string &path);
     static bool isDirectory(const std::string &path);
     static bool isReadable(const std::string &path);
     static std::string readFile(const std::string &path);
     static size_t getFileSize(const std::string &path);
+
+    // Open a regular file for streaming; returns the fd (caller closes it) and its size, or -1
+    static int openRegularFile(const std::string &path, size_t &size);
+
+    // Write content to path (truncating or creating it, mode 0644); 0 on success, -1 with errno
+    static int writeFile(const std::string &path, const std::string &content, bool &created);
 };
 
 #endif
\ No newline at end of file
@@ -16,7 +16,8 @@ public:
 		LEVEL_DEBUG = 0,
 		LEVEL_INFO = 1,
 		LEVEL_WARN = 2,
-		LEVEL_ERROR = 3
+		LEVEL_ERROR = 3,
+		LEVEL_OFF = 4 // setMinLevel(LEVEL_OFF) silences everything (benchmarks, fuzzing)
 	};
 
 	static void init();
@@ -25,8 +26,19 @@ public:
 	static void info(const std::string &msg);
 	static void warn(const std::string &msg);
 	static void error(const std::string &msg);
+
+	// Literal messages: the level is checked before a std::string is built,
+	// so disabled per-request logging costs no allocation
+	static void debug(const char *msg);
+	static void info(const char *msg);
+	static void warn(const char *msg);
+	static void error(const char *msg);
 	static void shutdown();
 
+	// Cheap level check so hot paths can skip building messages nobody will see
+	static bool isEnabled(Level lvl);
+	static void setMinLevel(Level lvl);
+
 	static std::string errnoMsg(const std::string &prefix);
 	static std::string fdMsg(const std::string &prefix, int fd);
 	static std::string connMsg(const std::string &prefix, int fd, const std::string &detail = "");
@@ -0,0 +1,101 @@
+#ifndef OPENFILECACHE_HPP
+#define OPENFILECACHE_HPP
+
+#include "utils/FileHandler.hpp"
+#include "utils/MimeTypes.hpp"
+#include "utils/Logger.hpp"
+#include "utils/defines.hpp"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <ctime>
+#include <string>
+#include <list>
+#include <map>
+
+// What a handler needs to know about a path before serving it
+struct FileInfo
+{
+	int fd;				  // Cache-owned fd of a regular file (-1 if not cached); use acquire() for your own
+	int error;			  // errno of the failed lookup (ENOENT, EACCES, ...), 0 on success
+	bool isDirectory;
+	size_t size;
+	time_t mtime;
+	ino_t inode;
+	std::string mimeType;
+
+	FileInfo() : fd(-1), error(0), isDirectory(false), size(0), mtime(0), inode(0) {}
+};
+
+// OpenFileCache: nginx-style open_file_cache, shared by every server and handler
+// A hot path is kept open with its metadata, so serving it costs no path
+// resolution at all: lookup() is a map hit and acquire() a dup of the cached fd.
+// - entries older than `valid` seconds are rechecked with one stat()
+// - entries unused for `inactive` seconds are closed (expireInactive())
+// - beyond `max` entries the least recently used one is closed
+// - with `errors on`, missing/forbidden paths are cached too (no stat per 404)
+// - the gzipped body of a file can be kept with its entry, so on-the-fly gzip
+//   compresses a static file once, not once per request
+// Disabled (the default), every lookup goes to the filesystem.
+class OpenFileCache
+{
+public:
+	static OpenFileCache *getInstance();
+
+	void configure(size_t maxEntries, time_t inactive, time_t valid, bool cacheErrors);
+	bool isEnabled() const;
+
+	// Metadata for path; false (info.error set) if it doesn't exist or can't be read
+	// (a missing/forbidden result is only kept with `errors on`, try_files probes included)
+	bool lookup(const std::string &path, FileInfo &info);
+
+	// Caller-owned fd for a regular file just returned by lookup(), -1 on failure
+	int acquire(const std::string &path, FileInfo &info);
+
+	// gzipped body of the file info describes (at that level); false if not kept or the file changed
+	bool getCompressed(const std::string &path, const FileInfo &info, int level, std::string &out);
+	void storeCompressed(const std::string &path, const FileInfo &info, int level, const std::string &data);
+
+	// Drop path after the server itself changed it (PUT, DELETE, upload)
+	void invalidate(const std::string &path);
+
+	// Close entries unused for the inactive period (called periodically by the event loop)
+	void expireInactive(time_t now);
+
+	// Close every cached fd
+	void clear();
+
+private:
+	struct Entry
+	{
+		std::string path;
+		FileInfo info;
+		time_t validated; // Last time info was checked against the filesystem
+		time_t lastUsed;
+		std::string compressed; // gzipped content ("" = none)
+		int compressedLevel;
+	};
+	typedef std::list<Entry> EntryList;
+
+	EntryList _entries; // Most recently used first
+	std::map<std::string, EntryList::iterator> _index;
+	size_t _maxEntries; // 0 = disabled
+	time_t _inactive;
+	time_t _valid;
+	bool _cacheErrors;
+	size_t _compressedBytes; // Held by all compressed bodies (bounded by GZIP_CACHE_BUDGET)
+
+	static OpenFileCache *_instance;
+
+	OpenFileCache();
+
+	static void load(const std::string &path, FileInfo &info, bool keepOpen);
+	static bool isCacheableError(int error);
+	bool isUnchanged(const Entry &entry) const;
+	static bool isSameFile(const FileInfo &a, const FileInfo &b);
+	void evict(EntryList::iterator it);
+};
+
+#endif
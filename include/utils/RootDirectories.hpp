@@ -0,0 +1,63 @@
+#ifndef ROOTDIRECTORIES_HPP
+#define ROOTDIRECTORIES_HPP
+
+#include "utils/Logger.hpp"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/openat2.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// RootDirectories: every root and upload_store, opened once as an O_PATH directory fd
+// A path under one of them (root + uri, as the handlers build it) is never walked
+// from the top again: it is resolved relative to the root's fd with
+// openat2(RESOLVE_BENEATH | RESOLVE_NO_SYMLINKS). The kernel itself refuses any
+// resolution that leaves the root ("..", absolute components) or follows a
+// symlink, so traversal is impossible whatever the URI looks like.
+// - an escape attempt fails with ENOENT, a symlink with EACCES (404 / 403)
+// - paths outside every registered directory are opened as before (open(2))
+// - kernels without openat2 (before 5.6) fall back to openat() on the root fd,
+//   with ".." components rejected and the last component not followed
+// Roots are only added while the config loads: open() and remove() are safe to
+// call from ThreadPool workers.
+class RootDirectories
+{
+public:
+	static RootDirectories *getInstance();
+
+	// Register dir (done for each location at config load); false if it can't be opened
+	bool add(const std::string &dir);
+
+	// open(2) / remove(3) for a path, beneath its root when it has one; -1 with errno on failure
+	int open(const std::string &path, int flags, mode_t mode = 0);
+	int remove(const std::string &path);
+
+	// Close every root fd
+	void clear();
+
+private:
+	struct Root
+	{
+		std::string path; // Without trailing '/' (except "/" itself)
+		int fd;
+	};
+
+	std::vector<Root> _roots; // Longest path first: the innermost root wins
+	bool _hasOpenat2;
+
+	static RootDirectories *_instance;
+
+	RootDirectories();
+
+	const Root *find(const std::string &path, const char *&relative) const;
+	int openBeneath(int dirFd, const char *relative, int flags, mode_t mode) const;
+	static bool probeOpenat2();
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef STRINGVIEW_HPP
+#define STRINGVIEW_HPP
+
+#include <string>
+#include <cstring>
+
+// StringView: non-owning (pointer, length) view of characters
+// C++98 has no std::string_view; this is the minimal subset the request path
+// needs to hand out header values and URI pieces without copying them.
+// A view is only valid while the buffer it points into is alive and unchanged.
+class StringView
+{
+public:
+	static const size_t npos = static_cast<size_t>(-1);
+
+	StringView() : _data(""), _size(0) {}
+	StringView(const char *data, size_t size) : _data(data), _size(size) {}
+	StringView(const char *cstr) : _data(cstr), _size(std::strlen(cstr)) {}
+	StringView(const std::string &str) : _data(str.data()), _size(str.size()) {}
+
+	const char *data() const { return _data; }
+	size_t size() const { return _size; }
+	size_t length() const { return _size; }
+	bool empty() const { return _size == 0; }
+	char operator[](size_t i) const { return _data[i]; }
+
+	// Materialize a copy (the only allocating operation)
+	std::string str() const { return std::string(_data, _size); }
+
+	StringView substr(size_t pos, size_t count = npos) const
+	{
+		if (pos > _size)
+			pos = _size;
+		if (count > _size - pos)
+			count = _size - pos;
+		return StringView(_data + pos, count);
+	}
+
+	size_t find(char c, size_t pos = 0) const
+	{
+		for (size_t i = pos; i < _size; ++i)
+		{
+			if (_data[i] == c)
+				return i;
+		}
+		return npos;
+	}
+
+	size_t find(const char *needle, size_t pos = 0) const
+	{
+		size_t n = std::strlen(needle);
+		for (size_t i = pos; i + n <= _size; ++i)
+		{
+			if (std::memcmp(_data + i, needle, n) == 0)
+				return i;
+		}
+		return npos;
+	}
+
+	bool equals(const StringView &other) const
+	{
+		return _size == other._size && std::memcmp(_data, other._data, _size) == 0;
+	}
+
+	// ASCII case-insensitive comparison (header names, tokens like "close")
+	bool iequals(const StringView &other) const
+	{
+		if (_size != other._size)
+			return false;
+		for (size_t i = 0; i < _size; ++i)
+		{
+			if (toLower(_data[i]) != toLower(other._data[i]))
+				return false;
+		}
+		return true;
+	}
+
+	static char toLower(char c)
+	{
+		return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+	}
+
+private:
+	const char *_data;
+	size_t _size;
+};
+
+inline bool operator==(const StringView &a, const StringView &b) { return a.equals(b); }
+inline bool operator!=(const StringView &a, const StringView &b) { return !a.equals(b); }
+inline bool operator==(const StringView &a, const char *b) { return a.equals(StringView(b)); }
+inline bool operator!=(const StringView &a, const char *b) { return !a.equals(StringView(b)); }
+
+#endif
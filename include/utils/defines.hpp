@@ -5,9 +5,17 @@
 // HTTP Status Codes
 // ============================================================================
 
+// 1xx Informational
+#define HTTP_CONTINUE 100
+
 // 2xx Success
 #define HTTP_OK 200
 #define HTTP_CREATED 201
+#define HTTP_NO_CONTENT 204
+#define HTTP_PARTIAL_CONTENT 206
+
+// 3xx Redirection
+#define HTTP_NOT_MODIFIED 304
 
 // 4xx Client Errors
 #define HTTP_BAD_REQUEST 400
@@ -15,12 +23,19 @@
 #define HTTP_NOT_FOUND 404
 #define HTTP_METHOD_NOT_ALLOWED 405
 #define HTTP_PAYLOAD_TOO_LARGE 413
+#define HTTP_URI_TOO_LONG 414
+#define HTTP_RANGE_NOT_SATISFIABLE 416
+#define HTTP_EXPECTATION_FAILED 417
+#define HTTP_REQUEST_HEADER_FIELDS_TOO_LARGE 431
 
 // 5xx Server Errors
 #define HTTP_INTERNAL_SERVER_ERROR 500
 #define HTTP_BAD_GATEWAY 502
 #define HTTP_LOOP_DETECTED 508
 
+// Server header and CGI SERVER_SOFTWARE
+#define SERVER_SOFTWARE "Webserv/1.0"
+
 // ============================================================================
 // Buffer and Limit Constants
 // ============================================================================
@@ -29,6 +44,34 @@
 #define MAX_BODY_SIZE 1048576 // 1MB (1024 * 1024)
 #define CGI_TIMEOUT_SEC 5     // 5 seconds timeout for CGI scripts
 
+// Request head limits (same defaults as nginx "large_client_header_buffers 4 8k")
+#define MAX_REQUEST_LINE 8192  // Longest request line, else 414
+#define MAX_HEADER_LINE 8192   // Longest single header line, else 431
+#define MAX_HEADER_COUNT 100   // Most header lines per request, else 431
+#define MAX_HEADER_SIZE 32768  // Request line + all headers, else 431
+
+// open_file_cache defaults (nginx: inactive=60s, open_file_cache_valid 60s)
+#define OPEN_FILE_CACHE_INACTIVE 60 // Seconds without a hit before an entry is closed
+#define OPEN_FILE_CACHE_VALID 60    // Seconds before an entry is rechecked with stat()
+
+// Largest file whose whole response is kept in the static response cache
+#define STATIC_CACHE_MAX_FILE 65536
+
+// On-the-fly gzip (nginx defaults: gzip_comp_level 1, gzip_min_length 20)
+#define GZIP_COMP_LEVEL 1
+#define GZIP_MIN_LENGTH 20
+#define GZIP_CHUNK_SIZE 16384        // Body bytes compressed per write event
+#define GZIP_CACHE_MAX_FILE 262144   // Largest static file whose gzipped body is kept in the open file cache
+#define GZIP_CACHE_BUDGET 16777216    // Bytes of gzipped bodies kept in the open file cache
+
+// Most ranges honoured in one Range header (after merging); beyond it the whole file is sent
+#define MAX_RANGES 16
+
+// Workers for blocking file operations (PUT, DELETE, uploads, autoindex), and how many
+// may wait for one; past that the event loop does the work itself
+#define THREAD_POOL_SIZE 4
+#define THREAD_POOL_QUEUE 256
+
 // ============================================================================
 // Default Server Configuration
 // ============================================================================
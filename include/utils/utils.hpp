@@ -9,6 +9,7 @@
 #include <sstream>
 #include <string>
 #include <cctype>
+#include <ctime>
 
 void printWebservStartup();
 
@@ -30,12 +31,21 @@ void skipWhitespace(const std::string &input, size_t &pos, int &line);
 void skipComment(const std::string &input, size_t &pos);
 bool isWordChar(char c);
 size_t parseSizeString(const std::string &str);
+time_t parseTimeString(const std::string &str);
+std::string formatHttpDate(time_t t);
+bool parseHttpDate(const StringView &str, time_t &out);
 
 // HTTP utilities
 HttpMethod stringToHttpMethod(const std::string &method);
+HttpMethod stringToHttpMethod(const char *method, size_t length);
+size_t parseDecimal(const char *str, size_t length);
+bool parseHex(const char *str, size_t length, size_t &out);
+bool sliceContains(const char *str, size_t length, const char *needle);
+bool percentDecode(const char *src, size_t length, char *dst, size_t &outLength, bool plusAsSpace);
+std::string percentDecode(const StringView &str, bool plusAsSpace);
+bool acceptsEncoding(const StringView &acceptEncoding, const char *coding);
 
 // APP utilities
-std::string buildFilePath(const std::string &uri, const std::string &rootDir, const std::string &defaultIndex);
 
 // Memory utilities
 void freeArray(char **array);
@@ -1,31 +1,172 @@
 #include "app/BaseMethodHandler.hpp"
 
-bool BaseMethodHandler::isCgiRequest(const std::string &path, const LocationConfig &config)
+HttpResponse BaseMethodHandler::executeCgi(const std::string &path, const std::string &interpreter)
 {
-    std::string extension = "";
-    size_t dotPos = path.rfind('.');
-    if (dotPos != std::string::npos)
-        extension = path.substr(dotPos);
+    Logger::info("CGI Request detected: " + path);
 
-    return !config.getCgiPath(extension).empty();
+    // Answered once the script is done
+    HttpResponse response;
+    response.setPending(new CgiTask(path, interpreter));
+    return response;
 }
 
-HttpResponse BaseMethodHandler::executeCgi(const std::string &path, const LocationConfig &config)
+// "$uri" in a try_files entry stands for the request path
+static std::string expandTryFile(const std::string &entry, const std::string &uri)
 {
-    Logger::info("CGI Request detected: " + path);
+    std::string out;
+    size_t start = 0;
+    size_t pos;
+    while ((pos = entry.find("$uri", start)) != std::string::npos)
+    {
+        out.append(entry, start, pos - start);
+        out += uri;
+        start = pos + 4;
+    }
+    out.append(entry, start, std::string::npos);
+    if (out.empty() || out[0] != '/')
+        out.insert(0, "/");
+    return out;
+}
 
-    // Determine interpreter
-    std::string extension = "";
-    size_t dotPos = path.rfind('.');
-    if (dotPos != std::string::npos)
-        extension = path.substr(dotPos);
+// Candidates go through the open file cache like any lookup. Misses are kept only with
+// `open_file_cache_errors on`: then a hot request for a missing asset (the SPA / front
+// controller case) probes the filesystem once per open_file_cache_valid period
+int BaseMethodHandler::resolveTryFiles(const std::string &uri, const LocationConfig &location, const std::string &rootDir,
+                                       std::string &filePath, FileInfo &info)
+{
+    const std::vector<std::string> &entries = location.getTryFiles();
+    OpenFileCache *cache = OpenFileCache::getInstance();
 
-    std::string interpreter = config.getCgiPath(extension);
+    for (size_t i = 0; i + 1 < entries.size(); i++)
+    {
+        std::string candidate = rootDir + expandTryFile(entries[i], uri);
+        bool wantDirectory = candidate[candidate.size() - 1] == '/';
+        FileInfo candidateInfo;
+        if (cache->lookup(candidate, candidateInfo) && candidateInfo.isDirectory == wantDirectory)
+        {
+            Logger::debug("try_files: " + candidate);
+            filePath = candidate;
+            info = candidateInfo;
+            return 0;
+        }
+    }
 
-    HttpResponse response;
-    // Mark as CGI pending
-    response.setCgi(true);
-    response.setCgiInfo(path, interpreter);
+    const std::string &fallback = entries.back();
+    if (fallback[0] == '=')
+        return std::atoi(fallback.c_str() + 1);
+
+    filePath = rootDir + expandTryFile(fallback, uri);
+    info = FileInfo();
+    cache->lookup(filePath, info);
+    Logger::debug("try_files fallback: " + filePath);
+    return 0;
+}
+
+HttpResponse BaseMethodHandler::fileErrorResponse(const FileInfo &info, const std::string &path)
+{
+    if (info.error == ENOENT || info.error == ENOTDIR || info.error == ENAMETOOLONG)
+    {
+        Logger::debug("File not found: " + path);
+        return StatusCodes::createErrorResponse(HTTP_NOT_FOUND, "Not Found");
+    }
+    if (info.error == EACCES)
+    {
+        Logger::warn("File not readable: " + path);
+        return StatusCodes::createErrorResponse(HTTP_FORBIDDEN, "Forbidden");
+    }
+    Logger::error("Failed to open file: " + path + ": " + std::strerror(info.error));
+    return StatusCodes::createErrorResponse(HTTP_INTERNAL_SERVER_ERROR, "Internal Server Error");
+}
+
+const char *BaseMethodHandler::selectPrecompressed(const HttpRequest &request, const LocationConfig &location,
+                                                   std::string &filePath, FileInfo &info)
+{
+    if (info.error != 0 || info.isDirectory)
+        return NULL;
+
+    // Brotli first: smaller than gzip for the same text
+    static const char *const codings[] = {"br", "gzip"};
+    static const char *const suffixes[] = {".br", ".gz"};
+    bool enabled[] = {location.getBrotliStatic(), location.getGzipStatic()};
+
+    StringView acceptEncoding = request.getHeader(HDR_ACCEPT_ENCODING);
+    for (size_t i = 0; i < 2; i++)
+    {
+        if (!enabled[i] || !acceptsEncoding(acceptEncoding, codings[i]))
+            continue;
+
+        std::string variantPath = filePath + suffixes[i];
+        FileInfo variant;
+        if (!OpenFileCache::getInstance()->lookup(variantPath, variant) || variant.isDirectory)
+            continue;
 
+        // Same representation, different coding: keep the original's Content-Type
+        variant.mimeType = info.mimeType;
+        filePath = variantPath;
+        info = variant;
+        return codings[i];
+    }
+    return NULL;
+}
+
+// W/"inode-size-mtime" in hex: changes whenever the file is replaced or rewritten.
+// Weak because it is derived from metadata, not content (and gzip may re-encode the body)
+std::string BaseMethodHandler::makeETag(const FileInfo &info)
+{
+    std::ostringstream os;
+    os << std::hex << "W/\"" << static_cast<unsigned long>(info.inode) << "-" << info.size << "-"
+       << static_cast<unsigned long>(info.mtime) << "\"";
+    return os.str();
+}
+
+void BaseMethodHandler::addValidators(HttpResponse &response, const FileInfo &info)
+{
+    response.addHeader("ETag", makeETag(info));
+    response.addHeader("Last-Modified", formatHttpDate(info.mtime));
+}
+
+bool BaseMethodHandler::isNotModified(const HttpRequest &request, const FileInfo &info)
+{
+    // If-None-Match wins over If-Modified-Since (RFC 9110 13.2.2); tags compare weakly
+    if (request.hasHeader(HDR_IF_NONE_MATCH))
+    {
+        StringView header = request.getHeader(HDR_IF_NONE_MATCH);
+        std::string etag = makeETag(info);
+        StringView opaque = StringView(etag).substr(2); // Without "W/"
+
+        size_t pos = 0;
+        while (pos < header.size())
+        {
+            size_t end = header.find(',', pos);
+            if (end == StringView::npos)
+                end = header.size();
+            StringView tag = header.substr(pos, end - pos);
+            pos = end + 1;
+
+            size_t b = 0, e = tag.size();
+            while (b < e && (tag[b] == ' ' || tag[b] == '\t'))
+                b++;
+            while (e > b && (tag[e - 1] == ' ' || tag[e - 1] == '\t'))
+                e--;
+            tag = tag.substr(b, e - b);
+            if (tag.size() >= 2 && tag[0] == 'W' && tag[1] == '/')
+                tag = tag.substr(2);
+            if (tag == "*" || tag == opaque)
+                return true;
+        }
+        return false;
+    }
+
+    time_t since;
+    if (request.hasHeader(HDR_IF_MODIFIED_SINCE) && parseHttpDate(request.getHeader(HDR_IF_MODIFIED_SINCE), since))
+        return info.mtime <= since;
+    return false;
+}
+
+HttpResponse BaseMethodHandler::notModifiedResponse(const FileInfo &info)
+{
+    HttpResponse response;
+    response.setStatus(HTTP_NOT_MODIFIED, "Not Modified");
+    addValidators(response, info);
     return response;
 }
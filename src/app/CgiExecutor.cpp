@@ -62,7 +62,8 @@ void CgiExecutor::start(const HttpRequest &request, const std::string &scriptPat
     {
         state.pid = pid;
         state.active = true;
-        state.requestBody = request.getBody();
+        state.requestBody = &request.getBody(); // Written from the request in place, no copy
+        state.bodyWritten = 0;
 
         // Close unused ends (Child's ends)
         close(state.pipeIn[0]);
@@ -107,44 +108,52 @@ char **CgiExecutor::createArgv(const std::string &scriptPath, const std::string
     return argv;
 }
 
+// Build one "NAME=value" entry straight into the buffer execve() receives
+static char *newEnvEntry(const std::string &name, const StringView &value)
+{
+    char *entry = new char[name.length() + 1 + value.size() + 1];
+    std::memcpy(entry, name.data(), name.length());
+    entry[name.length()] = '=';
+    std::memcpy(entry + name.length() + 1, value.data(), value.size());
+    entry[name.length() + 1 + value.size()] = '\0';
+    return entry;
+}
+
 char **CgiExecutor::createEnvp(const HttpRequest &request, const std::string &scriptPath)
 {
-    std::map<std::string, std::string> env;
-
-    env["GATEWAY_INTERFACE"] = "CGI/1.1";
-    env["SERVER_PROTOCOL"] = "HTTP/1.1";
-    env["SERVER_SOFTWARE"] = "Webserv/1.0";
-
-    env["REQUEST_METHOD"] = request.getMethodString();
-    env["SCRIPT_FILENAME"] = scriptPath;
-    env["SCRIPT_NAME"] = scriptPath; // Should be relative to root ideally
-    env["QUERY_STRING"] = "";        // Extract from URI if needed
-
-    // Extract Query String from URI
-    std::string uri = request.getUri();
-    size_t qPos = uri.find('?');
-    if (qPos != std::string::npos)
-        env["QUERY_STRING"] = uri.substr(qPos + 1);
-
-    // Headers to Env
-    std::string contentLength = request.getHeader("Content-Length");
-    if (!contentLength.empty())
-        env["CONTENT_LENGTH"] = contentLength;
-
-    std::string contentType = request.getHeader("Content-Type");
-    if (!contentType.empty())
-        env["CONTENT_TYPE"] = contentType;
-
-    // Add all other headers as HTTP_ variables
-    const std::map<std::string, std::string> &headers = request.getHeaders();
-    for (std::map<std::string, std::string>::const_iterator it = headers.begin(); it != headers.end(); ++it)
+    std::vector<char *> env;
+    env.reserve(10 + request.getHeaderCount());
+
+    env.push_back(newEnvEntry("GATEWAY_INTERFACE", "CGI/1.1"));
+    env.push_back(newEnvEntry("SERVER_PROTOCOL", "HTTP/1.1"));
+    env.push_back(newEnvEntry("SERVER_SOFTWARE", SERVER_SOFTWARE));
+
+    env.push_back(newEnvEntry("REQUEST_METHOD", request.getMethodString()));
+    env.push_back(newEnvEntry("SCRIPT_FILENAME", scriptPath));
+    env.push_back(newEnvEntry("SCRIPT_NAME", scriptPath)); // Should be relative to root ideally
+
+    // Query string was split off the URI by the request (empty if none)
+    env.push_back(newEnvEntry("QUERY_STRING", request.getQuery()));
+
+    // Walk the header table once; values are copied only into their final env entry
+    std::string envKey;
+    for (size_t h = 0; h < request.getHeaderCount(); ++h)
     {
-        std::string key = it->first;
-        // Skip Content-Length and Content-Type as they are already set
-        if (key == "Content-Length" || key == "Content-Type")
+        HttpHeaderId id = request.getHeaderId(h);
+        if (id == HDR_CONTENT_LENGTH)
+        {
+            env.push_back(newEnvEntry("CONTENT_LENGTH", request.getHeaderValue(h)));
+            continue;
+        }
+        if (id == HDR_CONTENT_TYPE)
+        {
+            env.push_back(newEnvEntry("CONTENT_TYPE", request.getHeaderValue(h)));
             continue;
+        }
 
-        std::string envKey = "HTTP_";
+        // Add all other headers as HTTP_ variables
+        StringView key = request.getHeaderName(h);
+        envKey.assign("HTTP_");
         for (size_t j = 0; j < key.length(); ++j)
         {
             char c = key[j];
@@ -153,21 +162,14 @@ char **CgiExecutor::createEnvp(const HttpRequest &request, const std::string &sc
             else
                 envKey += std::toupper(c);
         }
-        env[envKey] = it->second;
+        env.push_back(newEnvEntry(envKey, request.getHeaderValue(h)));
     }
 
     // Convert to char**
     char **envp = new char *[env.size() + 1];
-    int i = 0;
-    for (std::map<std::string, std::string>::iterator it = env.begin(); it != env.end(); ++it)
-    {
-        std::string s = it->first + "=" + it->second;
-        envp[i] = new char[s.length() + 1];
-        s.copy(envp[i], s.length());
-        envp[i][s.length()] = '\0';
-        i++;
-    }
-    envp[i] = NULL;
+    for (size_t i = 0; i < env.size(); ++i)
+        envp[i] = env[i];
+    envp[env.size()] = NULL;
 
     return envp;
 }
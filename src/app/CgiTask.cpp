@@ -0,0 +1,23 @@
+#include "app/CgiTask.hpp"
+
+CgiTask::CgiTask(const std::string &script, const std::string &interpreter)
+	: _script(script), _interpreter(interpreter)
+{
+}
+
+void CgiTask::start(int clientFd, AsyncContext &context)
+{
+	if (context.startCgi(clientFd, _script, _interpreter))
+		return;
+
+	Logger::error("Failed to start CGI");
+	HttpResponse response = StatusCodes::createErrorResponse(HTTP_INTERNAL_SERVER_ERROR, "CGI Start Failed");
+	context.complete(clientFd, response); // Deletes this
+}
+
+// Kill the script and close its pipes; nothing else refers to the task
+bool CgiTask::cancel(int clientFd, AsyncContext &context)
+{
+	context.stopCgi(clientFd);
+	return true;
+}
@@ -0,0 +1,228 @@
+#include "app/FileTasks.hpp"
+
+void BlockingTask::start(int clientFd, AsyncContext &context)
+{
+	if (context.submit(clientFd, this))
+		return;
+
+	// Pool off or saturated: block here rather than queue without bound
+	Logger::debug(Logger::connMsg("Thread pool busy, running file operation inline", clientFd));
+	run();
+	HttpResponse response = complete();
+	context.complete(clientFd, response); // Deletes this
+}
+
+// A worker may be running it right now: it is deleted when the pool hands it back
+bool BlockingTask::cancel(int, AsyncContext &)
+{
+	return false;
+}
+
+WriteFileTask::WriteFileTask(const std::string &path, std::string &content)
+	: _path(path), _created(false), _error(0)
+{
+	_content.swap(content);
+}
+
+void WriteFileTask::run()
+{
+	// Beneath the root: replaced if it exists, else created
+	if (FileHandler::writeFile(_path, _content, _created) != 0)
+		_error = errno;
+	std::string().swap(_content);
+}
+
+HttpResponse WriteFileTask::complete()
+{
+	if (_error != 0)
+	{
+		Logger::error("Failed to open file for writing (" + _path + "): " + std::string(strerror(_error)));
+		return StatusCodes::createErrorResponse(HTTP_INTERNAL_SERVER_ERROR, "Internal Server Error");
+	}
+	OpenFileCache::getInstance()->invalidate(_path);
+
+	// If the file already existed, respond with 200 OK
+	// Otherwise, respond with 201 Created (new resource)
+	HttpResponse res;
+	if (_created)
+		res.setStatus(HTTP_CREATED, "Created");
+	else
+		res.setStatus(HTTP_OK, "OK");
+	res.addHeader("Content-Length", "0");
+	return res;
+}
+
+RemoveFileTask::RemoveFileTask(const std::string &path)
+	: _path(path), _error(0)
+{
+}
+
+void RemoveFileTask::run()
+{
+	// Resolved beneath the root: no "..", no symlinks
+	if (RootDirectories::getInstance()->remove(_path) != 0)
+		_error = errno;
+}
+
+HttpResponse RemoveFileTask::complete()
+{
+	if (_error == ENOENT || _error == ENOTDIR)
+		return StatusCodes::createErrorResponse(HTTP_NOT_FOUND, "File not found");
+	if (_error != 0)
+	{
+		Logger::error("Failed to delete file (" + _path + "): " + std::string(strerror(_error)));
+		return StatusCodes::createErrorResponse(HTTP_INTERNAL_SERVER_ERROR, "Internal Server Error");
+	}
+
+	OpenFileCache::getInstance()->invalidate(_path);
+	Logger::info("File deleted successfully: " + _path);
+
+	HttpResponse res;
+	res.setStatus(HTTP_OK, "File deleted")
+		.addHeader("Content-Type", "text/plain")
+		.setBody("File successfully deleted");
+	return res;
+}
+
+UploadTask::UploadTask(const std::string &filename, std::string &content, const std::string &uploadDir)
+	: _filename(filename), _path(uploadDir + "/" + filename), _size(content.size()), _error(0)
+{
+	_content.swap(content);
+}
+
+void UploadTask::run()
+{
+	// NOTE: Upload directory must already exist
+	bool created;
+	if (FileHandler::writeFile(_path, _content, created) != 0)
+		_error = errno;
+	std::string().swap(_content);
+}
+
+HttpResponse UploadTask::complete()
+{
+	std::ostringstream html;
+	html << "<html><head><title>File Upload Result</title></head><body>";
+
+	HttpResponse response;
+	if (_error == 0)
+	{
+		OpenFileCache::getInstance()->invalidate(_path);
+		Logger::info("File saved: " + _path + " (" + toString(_size) + " bytes)");
+		Logger::info("File uploaded successfully: " + _filename);
+
+		html << "<h1>File Uploaded Successfully!</h1>";
+		html << "<p><strong>Filename:</strong> " << _filename << "</p>";
+		html << "<p><strong>Size:</strong> " << _size << " bytes</p>";
+		html << "<p>File saved to: /uploads/" << _filename << "</p>";
+		response.setStatus(HTTP_OK, "OK");
+	}
+	else
+	{
+		Logger::error("Failed to open file for writing: " + _path + " (" + std::string(strerror(_error)) + ")");
+		Logger::error("Failed to save uploaded file: " + _filename);
+
+		html << "<h1>Upload Failed</h1>";
+		html << "<p>Failed to save file: " << _filename << "</p>";
+		response.setStatus(HTTP_INTERNAL_SERVER_ERROR, "Internal Server Error");
+	}
+
+	html << "<br><a href=\"/\">Back to Home</a>";
+	html << "</body></html>";
+
+	std::string responseBody = html.str();
+	response.addHeader("Content-Type", "text/html")
+		.addHeader("Content-Length", toString(responseBody.size()))
+		.setBody(responseBody);
+	return response;
+}
+
+AutoIndexTask::AutoIndexTask(const std::string &dirPath)
+	: _dirPath(dirPath), _error(0)
+{
+}
+
+void AutoIndexTask::run()
+{
+	// Opened beneath the root like any file; entries are stat'ed relative to it
+	int dirFd = RootDirectories::getInstance()->open(_dirPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	DIR *dir = (dirFd < 0) ? NULL : fdopendir(dirFd);
+	if (dir == NULL)
+	{
+		_error = errno;
+		if (dirFd >= 0)
+			close(dirFd);
+		return;
+	}
+
+	std::ostringstream html;
+	html << "<html><head><title>Index of " << _dirPath << "</title></head><body>";
+	html << "<h1>Index of " << _dirPath << "</h1><hr><pre>";
+
+	struct dirent *entry;
+	while ((entry = readdir(dir)) != NULL)
+	{
+		std::string name = entry->d_name;
+		if (name == ".")
+			continue;
+
+		// Symlinks are listed as themselves, never followed
+		struct stat st;
+		bool found = fstatat(dirfd(dir), entry->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0;
+
+		// Add trailing slash for directories
+		bool isDir = found && S_ISDIR(st.st_mode);
+		if (isDir)
+			name += "/";
+
+		// Date and Size
+		std::string dateStr = "                   "; // 19 spaces
+		std::string sizeStr = "        -";
+
+		if (found)
+		{
+			// localtime_r: localtime()'s static result is shared with the loop thread
+			char buf[100];
+			struct tm tm;
+			localtime_r(&st.st_mtime, &tm);
+			std::strftime(buf, sizeof(buf), "%d-%b-%Y %H:%M", &tm);
+			dateStr = std::string(buf);
+			if (dateStr.length() < 19)
+				dateStr.resize(19, ' ');
+
+			if (!isDir)
+				sizeStr = toString(static_cast<unsigned long>(st.st_size));
+		}
+
+		// Output link (adjust spacing as needed)
+		// <a href="name">name</a>      date       size
+		html << "<a href=\"" << name << "\">" << name << "</a>";
+
+		// Padding
+		int pad = 50 - name.length();
+		if (pad < 0)
+			pad = 0;
+		html << std::string(pad, ' ');
+		html << dateStr << "       " << sizeStr << "\n";
+	}
+
+	html << "</pre><hr></body></html>";
+	closedir(dir);
+	_html = html.str();
+}
+
+HttpResponse AutoIndexTask::complete()
+{
+	if (_error != 0)
+	{
+		Logger::error("Failed to open directory for autoindex: " + _dirPath);
+		return StatusCodes::createErrorResponse(HTTP_INTERNAL_SERVER_ERROR, "Internal Server Error");
+	}
+
+	HttpResponse response;
+	response.setStatus(HTTP_OK, "OK");
+	response.setBody(_html);
+	response.addHeader("Content-Type", "text/html");
+	response.addHeader("Content-Length", toString(_html.length()));
+	return response;
+}
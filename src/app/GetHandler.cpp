@@ -1,7 +1,7 @@
 #include "app/GetHandler.hpp"
 
 HttpResponse GetHandler::handle(
-    const HttpRequest &request,
+    HttpRequest &request,
     const LocationConfig &location)
 {
     // Handle Redirection
@@ -25,7 +25,8 @@ HttpResponse GetHandler::handle(
         return response;
     }
 
-    std::string uri = request.getUri();
+    // Decoded path, query string and fragment already split off by the parser
+    std::string uri = request.getPath().str();
     std::string rootDir = location.getRoot();
 
     // Default to a sane default if root is empty (should ideally be handled in config validation)
@@ -41,29 +42,45 @@ HttpResponse GetHandler::handle(
         return StatusCodes::createErrorResponse(HTTP_NOT_FOUND, "Not Found");
     }
 
-    // Normalize URI (remove query strings, fragments)
-    // NOTE: normalized URI is used for file lookups, but raw URI with query string is passed to CGI
-    std::string safeUri = normalizeUri(uri);
-
     // We initially build the path without the index file
-    std::string filePath = buildFilePath(safeUri, rootDir, "");
+    // NOTE: the decoded path is used for file lookups, the raw query string is passed to CGI
+    // One lookup answers exists / directory / readable / size; a hot path costs no syscall
+    OpenFileCache *cache = OpenFileCache::getInstance();
+    std::string filePath;
+    FileInfo info;
+    if (!location.getTryFiles().empty())
+    {
+        int status = resolveTryFiles(uri, location, rootDir, filePath, info);
+        if (status != 0)
+            return StatusCodes::createErrorResponse(status, HttpResponse::reasonPhraseFor(status));
+    }
+    else
+    {
+        filePath = rootDir + (uri.empty() ? "/" : uri);
+        cache->lookup(filePath, info);
+    }
 
     // If it's a directory, check if we should serve the index file
-    if (FileHandler::isDirectory(filePath))
+    if (info.error == 0 && info.isDirectory)
     {
+        if (filePath[filePath.size() - 1] != '/')
+            filePath += "/";
+
         std::string defaultIndex = DEFAULT_INDEX;
         const std::vector<std::string> &indices = location.getIndex();
         if (!indices.empty())
             defaultIndex = indices[0];
 
-        std::string indexPath = filePath;
-        if (!indexPath.empty() && indexPath[indexPath.size() - 1] != '/')
-            indexPath += "/";
-        indexPath += defaultIndex;
+        std::string indexPath = filePath + defaultIndex;
 
         // If the index file exists, we serve that instead of the directory
-        if (FileHandler::fileExists(indexPath))
+        // (an unreadable one still replaces it, and gets its 403 in serveFile)
+        FileInfo indexInfo;
+        if (cache->lookup(indexPath, indexInfo) || indexInfo.error == EACCES)
+        {
             filePath = indexPath;
+            info = indexInfo;
+        }
         // Otherwise, we keep filePath as the directory path, which will trigger autoindex (if enabled)
         // or a 404/403 in serveFile
     }
@@ -71,11 +88,12 @@ HttpResponse GetHandler::handle(
     Logger::debug("Resolved file path: " + filePath);
 
     // Check for CGI
-    if (isCgiRequest(filePath, location))
-        return executeCgi(filePath, location);
+    const std::string *interpreter = location.findCgiInterpreter(filePath);
+    if (interpreter)
+        return executeCgi(filePath, *interpreter);
 
     // Serve the file
-    return serveFile(filePath, location.getAutoindex());
+    return serveFile(request, location, filePath, info);
 }
 
 bool GetHandler::isPathSafe(const std::string &uri)
@@ -99,141 +117,225 @@ bool GetHandler::isPathSafe(const std::string &uri)
     return true;
 }
 
-std::string GetHandler::normalizeUri(const std::string &uri)
+HttpResponse GetHandler::serveFile(const HttpRequest &request, const LocationConfig &location,
+                                   std::string filePath, FileInfo &info)
 {
-    // Find the first occurrence of either '?' (query) or '#' (fragment)
-    size_t endPos = uri.find_first_of("?#");
-
-    // If found, return everything before it
-    if (endPos != std::string::npos)
-        return uri.substr(0, endPos);
-
-    // Otherwise, return the URI unchanged
-    return uri;
-}
-
-HttpResponse GetHandler::serveFile(const std::string &filePath, bool autoindex)
-{
-    // Check if file exists
-    if (!FileHandler::fileExists(filePath))
-    {
-        Logger::debug("File not found: " + filePath);
-        return StatusCodes::createErrorResponse(HTTP_NOT_FOUND, "Not Found");
-    }
+    // Missing or unreadable
+    if (info.error != 0)
+        return fileErrorResponse(info, filePath);
 
     // Check if it's a directory
-    if (FileHandler::isDirectory(filePath))
+    if (info.isDirectory)
     {
-        if (autoindex)
-            return generateAutoIndex(filePath);
+        if (location.getAutoindex())
+        {
+            // Listed by a ThreadPool worker
+            HttpResponse response;
+            response.setPending(new AutoIndexTask(filePath));
+            return response;
+        }
 
         Logger::debug("Path is a directory: " + filePath);
         return StatusCodes::createErrorResponse(HTTP_FORBIDDEN, "Forbidden");
     }
 
-    // Check if file is readable
-    if (!FileHandler::isReadable(filePath))
+    // A precompressed sibling (file.br / file.gz) the client accepts replaces the file
+    const char *encoding = selectPrecompressed(request, location, filePath, info);
+
+    // The client's cached copy is still good: headers only
+    if (isNotModified(request, info))
     {
-        Logger::warn("File not readable: " + filePath);
-        return StatusCodes::createErrorResponse(HTTP_FORBIDDEN, "Forbidden");
+        Logger::debug("Not modified: " + filePath);
+        HttpResponse response = notModifiedResponse(info);
+        if (location.getGzipStatic() || location.getBrotliStatic())
+            response.addVary("Accept-Encoding");
+        return response;
     }
 
-    // Read file content
-    std::string content = FileHandler::readFile(filePath);
-    if (content.empty())
+    // Range: only the requested bytes are sent, as segments of the file
+    std::vector<ByteRange> ranges;
+    int rangeStatus = HTTP_OK;
+    if (request.hasHeader(HDR_RANGE) && ifRangeMatches(request, info))
+        rangeStatus = parseRanges(request.getHeader(HDR_RANGE), info.size, ranges);
+    if (rangeStatus == HTTP_RANGE_NOT_SATISFIABLE)
     {
-        size_t fileSize = FileHandler::getFileSize(filePath);
-        if (fileSize > 0)
-        {
-            Logger::error("Failed to read file: " + filePath);
-            return StatusCodes::createErrorResponse(HTTP_INTERNAL_SERVER_ERROR, "Internal Server Error");
-        }
-        // File is actually empty (size 0), serve it
+        Logger::debug("Unsatisfiable range for " + filePath);
+        HttpResponse response = StatusCodes::createErrorResponse(HTTP_RANGE_NOT_SATISFIABLE, "Range Not Satisfiable");
+        response.addHeader("Content-Range", "bytes */" + toString(info.size));
+        return response;
     }
 
-    // Determine MIME type
-    std::string mimeType = MimeTypes::getMimeType(filePath);
+    // Our own fd on the file; its content is never read here, the connection sends it with sendfile()
+    int fd = OpenFileCache::getInstance()->acquire(filePath, info);
+    if (fd < 0)
+    {
+        Logger::error("Failed to open file: " + filePath);
+        return StatusCodes::createErrorResponse(HTTP_INTERNAL_SERVER_ERROR, "Internal Server Error");
+    }
 
     // Build successful response
     HttpResponse response;
-    response.setStatus(HTTP_OK, "OK")
-        .addHeader("Content-Type", mimeType)
-        .addHeader("Content-Length", toString(content.size()))
-        .setBody(content);
+    response.addHeader("Accept-Ranges", "bytes");
+    addValidators(response, info);
+    if (ranges.size() > 1)
+        setMultipartRanges(response, fd, filePath, info, ranges);
+    else if (ranges.size() == 1)
+    {
+        size_t length = ranges[0].second - ranges[0].first + 1;
+        response.setStatus(HTTP_PARTIAL_CONTENT, "Partial Content")
+            .addHeader("Content-Type", info.mimeType)
+            .addHeader("Content-Length", toString(length))
+            .addHeader("Content-Range", "bytes " + toString(ranges[0].first) + "-" + toString(ranges[0].second) +
+                                            "/" + toString(info.size))
+            .setFileBody(fd, ranges[0].first, length, filePath);
+    }
+    else
+    {
+        response.setStatus(HTTP_OK, "OK")
+            .addHeader("Content-Type", info.mimeType)
+            .addHeader("Content-Length", toString(info.size))
+            .setFileBody(fd, 0, info.size, filePath);
+    }
+    if (encoding)
+        response.setContentEncoding(encoding);
+    // The body depends on Accept-Encoding as soon as a variant could be chosen
+    if (location.getGzipStatic() || location.getBrotliStatic())
+        response.addVary("Accept-Encoding");
 
-    Logger::info("Served file: " + filePath + " (" + mimeType + ", " + toString(content.size()) + " bytes)");
+    Logger::info("Served file: " + filePath + " (" + info.mimeType + ", " + toString(info.size) + " bytes)");
 
     return response;
 }
 
-HttpResponse GetHandler::generateAutoIndex(const std::string &dirPath)
+// If-Range: send the ranges only if the client's copy is still current, else the whole file
+// (an entity tag never matches: ours are weak, and If-Range needs a strong comparison)
+bool GetHandler::ifRangeMatches(const HttpRequest &request, const FileInfo &info)
 {
-    DIR *dir = opendir(dirPath.c_str());
-    if (dir == NULL)
-    {
-        Logger::error("Failed to open directory for autoindex: " + dirPath);
-        return StatusCodes::createErrorResponse(HTTP_INTERNAL_SERVER_ERROR, "Internal Server Error");
-    }
+    if (!request.hasHeader(HDR_IF_RANGE))
+        return true;
+    return request.getHeader(HDR_IF_RANGE) == StringView(formatHttpDate(info.mtime));
+}
 
-    std::ostringstream html;
-    html << "<html><head><title>Index of " << dirPath << "</title></head><body>";
-    html << "<h1>Index of " << dirPath << "</h1><hr><pre>";
+// "bytes=0-499", "bytes=500-", "bytes=-500", "bytes=0-0,-1" (RFC 9110 14.1.2)
+// HTTP_OK: no usable Range, send the whole file; HTTP_PARTIAL_CONTENT: ranges filled (sorted,
+// overlapping ones merged); HTTP_RANGE_NOT_SATISFIABLE: none of them lies inside the file
+int GetHandler::parseRanges(const StringView &header, size_t size, std::vector<ByteRange> &ranges)
+{
+    if (header.size() < 6 || !header.substr(0, 6).iequals("bytes="))
+        return HTTP_OK; // Unknown unit: ignored
 
-    struct dirent *entry;
-    while ((entry = readdir(dir)) != NULL)
+    bool anySpec = false;
+    size_t pos = 6;
+    while (pos <= header.size())
     {
-        std::string name = entry->d_name;
-        if (name == ".")
+        size_t end = header.find(',', pos);
+        if (end == StringView::npos)
+            end = header.size();
+        StringView spec = header.substr(pos, end - pos);
+        pos = end + 1;
+
+        // Trim OWS around the spec
+        size_t b = 0, e = spec.size();
+        while (b < e && (spec[b] == ' ' || spec[b] == '\t'))
+            b++;
+        while (e > b && (spec[e - 1] == ' ' || spec[e - 1] == '\t'))
+            e--;
+        spec = spec.substr(b, e - b);
+        if (spec.empty())
             continue;
-
-        // Add trailing slash for directories
-        std::string fullPath = dirPath;
-        if (fullPath[fullPath.length() - 1] != '/')
-            fullPath += "/";
-        fullPath += name;
-
-        bool isDir = FileHandler::isDirectory(fullPath);
-        if (isDir)
-            name += "/";
-
-        // Date and Size
-        struct stat st;
-        std::string dateStr = "                   "; // 19 spaces
-        std::string sizeStr = "        -";
-
-        if (stat(fullPath.c_str(), &st) == 0)
+        anySpec = true;
+
+        size_t dash = spec.find('-');
+        if (dash == StringView::npos)
+            return HTTP_OK; // Malformed: the whole header is ignored
+        StringView firstPart = spec.substr(0, dash);
+        StringView lastPart = spec.substr(dash + 1);
+        for (size_t i = 0; i < firstPart.size(); i++)
+            if (firstPart[i] < '0' || firstPart[i] > '9')
+                return HTTP_OK;
+        for (size_t i = 0; i < lastPart.size(); i++)
+            if (lastPart[i] < '0' || lastPart[i] > '9')
+                return HTTP_OK;
+
+        size_t first, last;
+        if (firstPart.empty())
         {
-            char buf[100];
-            struct tm *tm = std::localtime(&st.st_mtime);
-            std::strftime(buf, sizeof(buf), "%d-%b-%Y %H:%M", tm);
-            dateStr = std::string(buf);
-            if (dateStr.length() < 19)
-                dateStr.resize(19, ' ');
-
-            if (!isDir)
-                sizeStr = toString(static_cast<unsigned long>(st.st_size));
+            // Suffix range: the last N bytes
+            if (lastPart.empty())
+                return HTTP_OK;
+            size_t suffix = parseDecimal(lastPart.data(), lastPart.size());
+            if (suffix == 0 || size == 0)
+                continue;
+            first = suffix < size ? size - suffix : 0;
+            last = size - 1;
         }
+        else
+        {
+            first = parseDecimal(firstPart.data(), firstPart.size());
+            last = lastPart.empty() ? size - 1 : parseDecimal(lastPart.data(), lastPart.size());
+            if (!lastPart.empty() && last < first)
+                return HTTP_OK;
+            if (first >= size)
+                continue; // Unsatisfiable on its own
+            if (last >= size)
+                last = size - 1;
+        }
+        ranges.push_back(ByteRange(first, last));
+    }
 
-        // Output link (adjust spacing as needed)
-        // <a href="name">name</a>      date       size
-        html << "<a href=\"" << name << "\">" << name << "</a>";
+    // "bytes=" without a single range is invalid, and an invalid Range is ignored
+    if (!anySpec)
+        return HTTP_OK;
+    if (ranges.empty())
+        return HTTP_RANGE_NOT_SATISFIABLE;
 
-        // Padding
-        int pad = 50 - name.length();
-        if (pad < 0)
-            pad = 0;
-        html << std::string(pad, ' ');
-        html << dateStr << "       " << sizeStr << "\n";
+    // Overlapping or adjacent ranges are sent once (RFC 9110 allows coalescing)
+    std::sort(ranges.begin(), ranges.end());
+    size_t merged = 0;
+    for (size_t i = 1; i < ranges.size(); i++)
+    {
+        if (ranges[i].first <= ranges[merged].second + 1)
+            ranges[merged].second = std::max(ranges[merged].second, ranges[i].second);
+        else
+            ranges[++merged] = ranges[i];
     }
+    ranges.resize(merged + 1);
 
-    html << "</pre><hr></body></html>";
-    closedir(dir);
+    if (ranges.size() > MAX_RANGES)
+    {
+        ranges.clear();
+        return HTTP_OK;
+    }
+    return HTTP_PARTIAL_CONTENT;
+}
 
-    HttpResponse response;
-    response.setStatus(HTTP_OK, "OK");
-    response.setBody(html.str());
-    response.addHeader("Content-Type", "text/html");
-    response.addHeader("Content-Length", toString(html.str().length()));
+// multipart/byteranges: each part is its headers (in memory) followed by a segment of the file
+void GetHandler::setMultipartRanges(HttpResponse &response, int fd, const std::string &filePath,
+                                    const FileInfo &info, const std::vector<ByteRange> &ranges)
+{
+    static unsigned long counter = 0;
+    std::string boundary = toString(static_cast<unsigned long>(time(NULL))) + toString(++counter);
+    while (boundary.size() < 20)
+        boundary = "0" + boundary;
 
-    return response;
+    size_t total = 0;
+    for (size_t i = 0; i < ranges.size(); i++)
+    {
+        std::string head = "\r\n--" + boundary + "\r\nContent-Type: " + info.mimeType +
+                           "\r\nContent-Range: bytes " + toString(ranges[i].first) + "-" +
+                           toString(ranges[i].second) + "/" + toString(info.size) + "\r\n\r\n";
+        size_t length = ranges[i].second - ranges[i].first + 1;
+        if (i == 0)
+            response.setFileBody(fd, ranges[i].first, length, filePath).setFilePrefix(head);
+        else
+            response.addFileSegment(head, ranges[i].first, length);
+        total += head.size() + length;
+    }
+    std::string trailer = "\r\n--" + boundary + "--\r\n";
+    response.setFileTrailer(trailer);
+    total += trailer.size();
+
+    response.setStatus(HTTP_PARTIAL_CONTENT, "Partial Content")
+        .addHeader("Content-Type", "multipart/byteranges; boundary=" + boundary)
+        .addHeader("Content-Length", toString(total));
 }
@@ -1,7 +1,7 @@
 #include "app/HeadHandler.hpp"
 
 HttpResponse HeadHandler::handle(
-    const HttpRequest &request,
+    HttpRequest &request,
     const LocationConfig &location)
 {
     std::string rootDir = location.getRoot();
@@ -11,32 +11,59 @@ HttpResponse HeadHandler::handle(
     if (!location.getIndex().empty())
         defaultIndex = location.getIndex()[0];
 
-    std::string path = buildFilePath(request.getUri(), rootDir, defaultIndex);
-    Logger::info("HEAD request for: " + path);
-
-    // Check if file exists
-    if (!FileHandler::fileExists(path))
+    // Resolved like GET (try_files, then the index of a directory), without reading anything
+    std::string uri = request.getPath().str();
+    OpenFileCache *cache = OpenFileCache::getInstance();
+    std::string path;
+    FileInfo info;
+    if (!location.getTryFiles().empty())
+    {
+        int status = resolveTryFiles(uri, location, rootDir, path, info);
+        if (status != 0)
+            return StatusCodes::createErrorResponse(status, HttpResponse::reasonPhraseFor(status));
+    }
+    else
+    {
+        path = rootDir + (uri.empty() ? "/" : uri);
+        cache->lookup(path, info);
+    }
+    if (info.error == 0 && info.isDirectory)
     {
-        Logger::warn("File not found: " + path);
-        return StatusCodes::createErrorResponse(HTTP_NOT_FOUND, "Not Found");
+        if (path[path.size() - 1] != '/')
+            path += "/";
+        path += defaultIndex;
+        cache->lookup(path, info);
     }
+    Logger::info("HEAD request for: " + path);
+
+    // Exists / readable / size in one (usually cached) lookup
+    if (info.error != 0)
+        return fileErrorResponse(info, path);
 
-    // Check readability
-    if (!FileHandler::isReadable(path))
+    // Same headers GET would send, precompressed variant included
+    const char *encoding = selectPrecompressed(request, location, path, info);
+
+    if (isNotModified(request, info))
     {
-        Logger::warn("File not readable: " + path);
-        return StatusCodes::createErrorResponse(HTTP_FORBIDDEN, "Forbidden");
+        HttpResponse res = notModifiedResponse(info);
+        if (location.getGzipStatic() || location.getBrotliStatic())
+            res.addVary("Accept-Encoding");
+        return res;
     }
 
     // Build headers
     HttpResponse res;
     res.setStatus(HTTP_OK, "OK");
 
-    std::string mime = MimeTypes::getMimeType(path);
-    size_t fileSize = FileHandler::getFileSize(path);
-
-    res.addHeader("Content-Type", mime);
-    res.addHeader("Content-Length", toString(fileSize));
+    res.addHeader("Content-Type", info.mimeType);
+    res.addHeader("Content-Length", toString(info.size));
+    res.addHeader("Accept-Ranges", "bytes");
+    res.setFilePath(path); // For GzipFilter: the cached gzipped length of this file
+    addValidators(res, info);
+    if (encoding)
+        res.setContentEncoding(encoding);
+    if (location.getGzipStatic() || location.getBrotliStatic())
+        res.addVary("Accept-Encoding");
 
     // No body for HEAD
     return res;
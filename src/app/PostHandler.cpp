@@ -1,7 +1,7 @@
 #include "app/PostHandler.hpp"
 
 HttpResponse PostHandler::handle(
-	const HttpRequest &request,
+	HttpRequest &request,
 	const LocationConfig &location)
 {
 	std::string rootDir = location.getRoot();
@@ -11,14 +11,10 @@ HttpResponse PostHandler::handle(
 	if (!location.getIndex().empty())
 		defaultIndex = location.getIndex()[0];
 
-	std::string uri = request.getUri();
+	// Path without query string / fragment (split once by the request)
+	std::string uri = request.getPath().str();
 	Logger::info("PostHandler processing: " + uri);
 
-	// Normalize URI (remove query strings, fragments)
-	size_t endPos = uri.find_first_of("?#");
-	if (endPos != std::string::npos)
-		uri = uri.substr(0, endPos);
-
 	// Build file path (Simple manual construction for now)
 	std::string filePath = rootDir;
 	if (!filePath.empty() && filePath[filePath.size() - 1] != '/' && !uri.empty() && uri[0] != '/')
@@ -34,38 +30,39 @@ HttpResponse PostHandler::handle(
 	}
 
 	// Check for CGI
-	if (isCgiRequest(filePath, location))
-		return executeCgi(filePath, location);
+	const std::string *interpreter = location.findCgiInterpreter(filePath);
+	if (interpreter)
+		return executeCgi(filePath, *interpreter);
 
 	// Check if request has a body
-	if (request.getHeader("Content-Length") == "")
+	if (!request.hasHeader(HDR_CONTENT_LENGTH))
 	{
 		Logger::warn("POST request without Content-Length header");
 		return StatusCodes::createErrorResponse(HTTP_BAD_REQUEST, "Bad Request");
 	}
 
 	// Get content type
-	std::string contentType = request.getHeader("Content-Type");
+	StringView contentType = request.getHeader(HDR_CONTENT_TYPE);
 
 	// Handle multipart/form-data (file uploads)
-	if (contentType.find("multipart/form-data") != std::string::npos)
+	if (contentType.find("multipart/form-data") != StringView::npos)
 		return handleFileUpload(request, location);
 
 	// Handle application/x-www-form-urlencoded (regular forms)
-	else if (contentType.find("application/x-www-form-urlencoded") != std::string::npos)
+	else if (contentType.find("application/x-www-form-urlencoded") != StringView::npos)
 		return handleFormSubmission(request);
 
 	// Unsupported content type
 	else
 	{
-		Logger::warn("Unsupported Content-Type: " + contentType);
+		Logger::warn("Unsupported Content-Type: " + contentType.str());
 		return StatusCodes::createErrorResponse(HTTP_BAD_REQUEST, "Bad Request");
 	}
 }
 
 HttpResponse PostHandler::handleFormSubmission(const HttpRequest &request)
 {
-	std::string body = request.getBody();
+	const std::string &body = request.getBody();
 	Logger::debug("Form data received: " + body);
 
 	std::map<std::string, std::string> formData = parseFormData(body);
@@ -108,19 +105,19 @@ HttpResponse PostHandler::handleFileUpload(
 
 	Logger::info("Processing file upload");
 
-	std::string body = request.getBody();
-	std::string contentType = request.getHeader("Content-Type");
+	const std::string &body = request.getBody();
+	StringView contentType = request.getHeader(HDR_CONTENT_TYPE);
 
 	// Extract boundary from Content-Type header
 	// Example: multipart/form-data; boundary=----WebKitFormBoundary7MA4YWxkTrZu0gW
 	size_t boundaryPos = contentType.find("boundary=");
-	if (boundaryPos == std::string::npos)
+	if (boundaryPos == StringView::npos)
 	{
 		Logger::error("No boundary found in multipart/form-data");
 		return StatusCodes::createErrorResponse(HTTP_BAD_REQUEST, "Bad Request");
 	}
 
-	std::string boundary = "--" + contentType.substr(boundaryPos + 9);
+	std::string boundary = "--" + contentType.substr(boundaryPos + 9).str();
 	Logger::debug("Boundary: " + boundary);
 
 	// Find file content between boundaries
@@ -166,133 +163,32 @@ HttpResponse PostHandler::handleFileUpload(
 		return StatusCodes::createErrorResponse(HTTP_INTERNAL_SERVER_ERROR, "Internal Server Error");
 	}
 
-	// Save file
-	bool saved = saveUploadedFile(filename, fileContent, uploadDir);
-
-	// Generate response
-	std::string responseBody = generateUploadResponse(filename, fileContent.size(), saved);
-
+	// Saved by a ThreadPool worker; the result page is built when it is done
 	HttpResponse response;
-	if (saved)
-	{
-		response.setStatus(HTTP_OK, "OK");
-		Logger::info("File uploaded successfully: " + filename);
-	}
-	else
-	{
-		response.setStatus(HTTP_INTERNAL_SERVER_ERROR, "Internal Server Error");
-		Logger::error("Failed to save uploaded file: " + filename);
-	}
-
-	response.addHeader("Content-Type", "text/html")
-		.addHeader("Content-Length", toString(responseBody.size()))
-		.setBody(responseBody);
-
+	response.setPending(new UploadTask(filename, fileContent, uploadDir));
 	return response;
 }
 
 std::map<std::string, std::string> PostHandler::parseFormData(const std::string &body)
 {
 	std::map<std::string, std::string> data;
+	StringView rest(body);
 
-	// Split by '&'
-	size_t start = 0;
-	size_t ampPos = 0;
-
-	while ((ampPos = body.find('&', start)) != std::string::npos)
+	// Split by '&', then by '='; pairs are views of the body until decoded
+	while (!rest.empty())
 	{
-		std::string pair = body.substr(start, ampPos - start);
-
-		// Split by '='
-		size_t eqPos = pair.find('=');
-		if (eqPos != std::string::npos)
-		{
-			std::string key = pair.substr(0, eqPos);
-			std::string value = pair.substr(eqPos + 1);
-
-			// URL decode (basic - replace + with space)
-			for (size_t i = 0; i < value.length(); i++)
-			{
-				if (value[i] == '+')
-					value[i] = ' ';
-			}
+		size_t ampPos = rest.find('&');
+		StringView pair = rest.substr(0, ampPos);
+		rest = (ampPos == StringView::npos) ? StringView() : rest.substr(ampPos + 1);
 
-			data[key] = value;
-		}
-
-		start = ampPos + 1;
-	}
-
-	// Handle last pair
-	if (start < body.length())
-	{
-		std::string pair = body.substr(start);
 		size_t eqPos = pair.find('=');
-		if (eqPos != std::string::npos)
+		if (eqPos != StringView::npos)
 		{
-			std::string key = pair.substr(0, eqPos);
-			std::string value = pair.substr(eqPos + 1);
-
-			for (size_t i = 0; i < value.length(); i++)
-			{
-				if (value[i] == '+')
-					value[i] = ' ';
-			}
-
-			data[key] = value;
+			// URL decode ('+' is a space, %XX escapes) with the same decoder as the request target
+			std::string key = percentDecode(pair.substr(0, eqPos), true);
+			data[key] = percentDecode(pair.substr(eqPos + 1), true);
 		}
 	}
 
 	return data;
 }
-
-bool PostHandler::saveUploadedFile(
-	const std::string &filename,
-	const std::string &content,
-	const std::string &uploadDir)
-{
-	// NOTE: Upload directory must already exist
-	// Build full file path
-	std::string filePath = uploadDir + "/" + filename;
-
-	// Write file
-	std::ofstream file(filePath.c_str(), std::ios::binary);
-	if (!file.is_open())
-	{
-		Logger::error("Failed to open file for writing: " + filePath);
-		return false;
-	}
-
-	file.write(content.c_str(), content.size());
-	file.close();
-
-	Logger::info("File saved: " + filePath + " (" + toString(content.size()) + " bytes)");
-	return true;
-}
-
-std::string PostHandler::generateUploadResponse(
-	const std::string &filename,
-	size_t fileSize,
-	bool success)
-{
-	std::ostringstream html;
-	html << "<html><head><title>File Upload Result</title></head><body>";
-
-	if (success)
-	{
-		html << "<h1>File Uploaded Successfully!</h1>";
-		html << "<p><strong>Filename:</strong> " << filename << "</p>";
-		html << "<p><strong>Size:</strong> " << fileSize << " bytes</p>";
-		html << "<p>File saved to: /uploads/" << filename << "</p>";
-	}
-	else
-	{
-		html << "<h1>Upload Failed</h1>";
-		html << "<p>Failed to save file: " << filename << "</p>";
-	}
-
-	html << "<br><a href=\"/\">Back to Home</a>";
-	html << "</body></html>";
-
-	return html.str();
-}
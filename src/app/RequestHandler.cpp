@@ -31,37 +31,59 @@ void RequestHandler::cleanup()
 	handlers.clear();
 }
 
-HttpResponse RequestHandler::handleRequest(
+bool RequestHandler::checkRequest(
 	const HttpRequest &request,
-	const LocationConfig &location)
+	const LocationConfig &location,
+	size_t bodySize,
+	HttpResponse &rejection) const
 {
-	HttpMethod method = request.getMethod();
 	std::string methodStr = request.getMethodString();
 
-	Logger::info("RequestHandler routing: " + methodStr + " " + request.getUri());
-
-	// Check for special session test path
-	if (request.getUri() == "/session_test")
-	{
-		SessionHandler handler;
-		return handler.handle(request);
-	}
+	// The session test page is handled before any location rule
+	if (request.getPath() == "/session_test")
+		return true;
 
 	// Check client_max_body_size for this location
 	size_t maxBodySize = location.getClientMaxBodySize();
-	if (maxBodySize > 0 && request.getBody().size() > maxBodySize)
+	if (maxBodySize > 0 && bodySize > maxBodySize)
 	{
-		Logger::warn("Body size exceeds location limit: " + toString(request.getBody().size()) + " > " + toString(maxBodySize));
-		return StatusCodes::createErrorResponse(HTTP_PAYLOAD_TOO_LARGE, "Payload Too Large");
+		Logger::warn("Body size exceeds location limit: " + toString(bodySize) + " > " + toString(maxBodySize));
+		rejection = StatusCodes::createErrorResponse(HTTP_PAYLOAD_TOO_LARGE, "Payload Too Large");
+		return false;
 	}
 
 	// Check if method is allowed in this location
 	if (!location.isMethodAllowed(methodStr))
 	{
-		Logger::warn("Method not allowed: " + methodStr + " for URI: " + request.getUri());
-		return StatusCodes::createErrorResponse(HTTP_METHOD_NOT_ALLOWED, "Method Not Allowed");
+		Logger::warn("Method not allowed: " + methodStr + " for URI: " + request.getUri().str());
+		rejection = StatusCodes::createErrorResponse(HTTP_METHOD_NOT_ALLOWED, "Method Not Allowed");
+		return false;
+	}
+	return true;
+}
+
+HttpResponse RequestHandler::handleRequest(
+	HttpRequest &request,
+	const LocationConfig &location)
+{
+	HttpMethod method = request.getMethod();
+	std::string methodStr = request.getMethodString();
+
+	Logger::info("RequestHandler routing: " + methodStr + " " + request.getUri().str());
+
+	// Check for special session test path
+	if (request.getPath() == "/session_test")
+	{
+		SessionHandler handler;
+		return handler.handle(request);
 	}
 
+	// Same checks that already ran when the headers arrived; repeated here so
+	// the body actually received (e.g. chunked) is held to the location limit too
+	HttpResponse rejection;
+	if (!checkRequest(request, location, request.getBodySize(), rejection))
+		return rejection;
+
 	// Find the appropriate handler (Strategy)
 	std::map<HttpMethod, IMethodHandler *>::iterator it = handlers.find(method);
 
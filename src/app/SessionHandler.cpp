@@ -15,7 +15,7 @@ HttpResponse SessionHandler::handle(const HttpRequest &request)
     HttpResponse response;
     SessionManager *sm = SessionManager::getInstance();
     std::string sessionId = request.getCookie("SESSIONID");
-    std::string action = request.getHeader("X-Action"); // Simple way to signal action
+    std::string action = request.getHeader("X-Action").str(); // Simple way to signal action
 
     std::string body = "<!DOCTYPE html><html lang='en'><head><meta charset='UTF-8'><meta name='viewport' content='width=device-width,initial-scale=1'><title>WebServ - Session Manager</title>";
     body += "<style>*{margin:0;padding:0;box-sizing:border-box}:root{--bg:#0a0a0f;--surface:#141419;--border:rgba(240,192,64,.08);--text:#f1f1f1;--text-dim:#b4b4b4;--primary:#f0c040;--success:#4caf50;--error:#e74c3c;--info:#2196f3;--radius:12px}body{background:var(--bg);color:var(--text);font-family:-apple-system,BlinkMacSystemFont,'Segoe UI',Roboto,Oxygen,Ubuntu,Cantarell,sans-serif;line-height:1.6;min-height:100vh;padding:20px}.container{max-width:1200px;margin:0 auto}header{text-align:center;padding:3rem 1rem;border-bottom:1px solid var(--border);margin-bottom:2rem}h1{font-size:2.5rem;color:var(--primary);margin-bottom:.5rem;font-weight:700}h2{font-size:1.4rem;color:var(--text);margin-bottom:1rem;font-weight:600}h3{font-size:1.1rem;color:var(--text);margin-bottom:.5rem}.subtitle{color:var(--text-dim);font-size:1.1rem}.back-btn-container{display:flex;justify-content:center;margin-bottom:2rem}.back-btn{display:inline-flex;align-items:center;gap:.5rem;color:var(--text);text-decoration:none;padding:.7rem 1.5rem;border-radius:20px;background:var(--surface);border:1px solid var(--border);transition:all .3s;font-size:.95rem}.back-btn:hover{background:var(--primary);color:var(--bg);border-color:var(--primary);transform:translateX(-3px)}.card-grid{display:grid;grid-template-columns:repeat(auto-fit,minmax(380px,1fr));gap:2rem;margin-bottom:2rem}.card{background:var(--surface);border:1px solid var(--border);border-radius:var(--radius);padding:2rem;transition:transform .3s}.card:hover{transform:translateY(-2px)}.status-badge{display:inline-block;padding:.75rem 1.5rem;border-radius:8px;font-weight:600;margin-bottom:1rem}.status-badge.success{background:rgba(76,175,80,.15);color:var(--success);border:1px solid rgba(76,175,80,.3)}.status-badge.info{background:rgba(33,150,243,.15);color:var(--info);border:1px solid rgba(33,150,243,.3)}.status-badge.new{background:rgba(240,192,64,.15);color:var(--primary);border:1px solid rgba(240,192,64,.3)}code{background:rgba(240,192,64,.1);color:var(--primary);padding:.3rem .6rem;border-radius:6px;font-size:.9rem;font-family:monospace;word-break:break-all}.data-list{list-style:none;margin:1rem 0}.data-list li{padding:.75rem 1rem;background:rgba(240,192,64,.05);border-left:3px solid var(--primary);margin-bottom:.5rem;border-radius:4px}.data-list li strong{color:var(--primary);margin-right:.5rem}.empty-state{color:var(--text-dim);font-style:italic;padding:1.5rem;text-align:center;background:rgba(180,180,180,.05);border-radius:8px}.form-group{margin-bottom:1.5rem}label{display:block;margin-bottom:.5rem;font-weight:600;color:var(--text-dim);font-size:.9rem}input[type=text]{width:100%;padding:.85rem 1rem;background:rgba(255,255,255,.05);border:1px solid var(--border);border-radius:8px;color:var(--text);font-size:1rem;transition:all .3s}input[type=text]:focus{outline:none;border-color:var(--primary);background:rgba(240,192,64,.08)}.btn{width:100%;padding:.85rem 1.5rem;border:none;border-radius:8px;font-size:1rem;font-weight:600;cursor:pointer;transition:all .3s}.btn-primary{background:linear-gradient(135deg,var(--primary),#d4a830);color:var(--bg)}.btn-primary:hover{transform:translateY(-2px);box-shadow:0 4px 12px rgba(240,192,64,.3)}.btn-danger{background:linear-gradient(135deg,var(--error),#c0392b);color:#fff;margin-top:1.5rem}.btn-danger:hover{transform:translateY(-2px);box-shadow:0 4px 12px rgba(231,76,60,.3)}.divider{border-top:1px solid var(--border);margin:1.5rem 0;padding-top:1.5rem}.session-id{font-size:.85rem;color:var(--text-dim);margin-top:.5rem}.success-msg{background:rgba(76,175,80,.15);color:var(--success);padding:.75rem 1rem;border-radius:8px;margin:.75rem 0;border-left:3px solid var(--success)}footer{text-align:center;padding:2rem 1rem;margin-top:3rem;border-top:1px solid var(--border);color:var(--text-dim);font-size:.9rem}@media(max-width:768px){h1{font-size:2rem}.card-grid{grid-template-columns:1fr}.container{padding:0}}</style></head><body>";
@@ -44,7 +44,7 @@ HttpResponse SessionHandler::handle(const HttpRequest &request)
         if (request.getMethod() == HTTP_POST)
         {
             // Parse simple form data (key=value)
-            std::string reqBody = request.getBody();
+            const std::string &reqBody = request.getBody();
 
             // Simple URL-encoded body parser
             std::map<std::string, std::string> params;
@@ -45,7 +45,12 @@ bool ConfigParser::isServerDirective(const std::string &word) const
 {
 	return word == "listen" || word == "server_name" || word == "root" ||
 		   word == "index" || word == "client_max_body_size" ||
-		   word == "error_page";
+		   word == "error_page" || word == "large_client_header_buffers" ||
+		   word == "client_max_request_line" || word == "client_max_header_line" ||
+		   word == "client_max_header_count" || word == "client_max_header_size" ||
+		   word == "open_file_cache" || word == "open_file_cache_valid" ||
+		   word == "open_file_cache_errors" || word == "static_cache" ||
+		   word == "static_cache_max_file";
 }
 
 // Check if word is a location directive
@@ -53,7 +58,10 @@ bool ConfigParser::isLocationDirective(const std::string &word) const
 {
 	return word == "root" || word == "index" || word == "allowed_methods" ||
 		   word == "autoindex" || word == "client_max_body_size" ||
-		   word == "upload_store" || word == "cgi_assign" || word == "return";
+		   word == "upload_store" || word == "cgi_assign" || word == "return" ||
+		   word == "gzip_static" || word == "brotli_static" ||
+		   word == "gzip" || word == "gzip_comp_level" || word == "gzip_min_length" || word == "gzip_types" ||
+		   word == "expires" || word == "add_header" || word == "try_files";
 }
 
 // ============================================================================
@@ -134,27 +142,70 @@ bool ConfigParser::parseServerDirective(ServerConfig &server)
 		return ConfigDirectives::parseClientMaxBodySize(_tokens, _pos, server, _error);
 	else if (directive.value == "error_page")
 		return ConfigDirectives::parseErrorPage(_tokens, _pos, server, _error);
+	else if (directive.value == "large_client_header_buffers")
+		return ConfigDirectives::parseLargeClientHeaderBuffers(_tokens, _pos, server, _error);
+	else if (directive.value == "client_max_request_line" || directive.value == "client_max_header_line" ||
+			 directive.value == "client_max_header_count" || directive.value == "client_max_header_size")
+		return ConfigDirectives::parseHeaderLimit(_tokens, _pos, server, _error);
+	else if (directive.value == "open_file_cache")
+		return ConfigDirectives::parseOpenFileCache(_tokens, _pos, server, _error);
+	else if (directive.value == "open_file_cache_valid")
+		return ConfigDirectives::parseOpenFileCacheValid(_tokens, _pos, server, _error);
+	else if (directive.value == "open_file_cache_errors")
+		return ConfigDirectives::parseOpenFileCacheErrors(_tokens, _pos, server, _error);
+	else if (directive.value == "static_cache" || directive.value == "static_cache_max_file")
+		return ConfigDirectives::parseStaticCache(_tokens, _pos, server, _error);
 
 	return true;
 }
 
-// Parse: location /path { ... }
+// Parse: location [= | ~ | ~* | ^~] /path { ... }
 bool ConfigParser::parseLocation(ServerConfig &server)
 {
 	Token token = advance(); // Consume 'location'
 
 	Token path = advance();
+	LocationMatch match = MATCH_PREFIX;
+	if (path.type == TOKEN_WORD && (path.value == "=" || path.value == "~" || path.value == "~*" || path.value == "^~"))
+	{
+		if (path.value == "=")
+			match = MATCH_EXACT;
+		else if (path.value == "~")
+			match = MATCH_REGEX;
+		else if (path.value == "~*")
+			match = MATCH_REGEX_ICASE;
+		else
+			match = MATCH_PREFIX_NO_REGEX;
+		path = advance();
+	}
 	if (path.type != TOKEN_WORD)
 	{
 		setError("Expected path after 'location'", path.line);
 		return false;
 	}
 
+	// Compiled for real when the server starts; a bad pattern is reported here, with its line
+	if (match == MATCH_REGEX || match == MATCH_REGEX_ICASE)
+	{
+		regex_t regex;
+		int flags = REG_EXTENDED | REG_NOSUB | (match == MATCH_REGEX_ICASE ? REG_ICASE : 0);
+		int ret = regcomp(&regex, path.value.c_str(), flags);
+		if (ret != 0)
+		{
+			char message[128];
+			regerror(ret, &regex, message, sizeof(message));
+			setError("Invalid location regex \"" + path.value + "\": " + message, path.line);
+			return false;
+		}
+		regfree(&regex);
+	}
+
 	if (!expect(TOKEN_OPEN_BRACE))
 		return false;
 	advance(); // Consume '{'
 
 	LocationConfig location(path.value);
+	location.setMatch(match);
 
 	// Parse directives inside location block
 	while (true)
@@ -210,6 +261,17 @@ bool ConfigParser::parseLocationDirective(LocationConfig &location)
 		return ConfigDirectives::parseLocationIndex(_tokens, _pos, location, _error);
 	else if (directive.value == "autoindex")
 		return ConfigDirectives::parseAutoindex(_tokens, _pos, location, _error);
+	else if (directive.value == "gzip_static" || directive.value == "brotli_static")
+		return ConfigDirectives::parseStaticCompression(_tokens, _pos, location, _error);
+	else if (directive.value == "gzip" || directive.value == "gzip_comp_level" ||
+			 directive.value == "gzip_min_length" || directive.value == "gzip_types")
+		return ConfigDirectives::parseGzip(_tokens, _pos, location, _error);
+	else if (directive.value == "expires")
+		return ConfigDirectives::parseExpires(_tokens, _pos, location, _error);
+	else if (directive.value == "add_header")
+		return ConfigDirectives::parseAddHeader(_tokens, _pos, location, _error);
+	else if (directive.value == "try_files")
+		return ConfigDirectives::parseTryFiles(_tokens, _pos, location, _error);
 	else if (directive.value == "client_max_body_size")
 		return ConfigDirectives::parseClientMaxBodySize(_tokens, _pos, location, _error);
 	else if (directive.value == "upload_store")
@@ -1,27 +1,43 @@
 #include "config/LocationConfig.hpp"
+#include "http/HttpResponse.hpp"
+#include "utils/defines.hpp"
 
 LocationConfig::LocationConfig()
 	: path("/"),
+	  match(MATCH_PREFIX),
 	  root(""),
 	  autoindex(false),
+	  gzipStatic(false),
+	  brotliStatic(false),
+	  gzip(false),
+	  gzipCompLevel(GZIP_COMP_LEVEL),
+	  gzipMinLength(GZIP_MIN_LENGTH),
 	  clientMaxBodySize(0), // 0 means not set (inherit from server)
 	  uploadStore(""),
 	  redirect(""),
 	  redirectCode(0)
 {
 	// No default methods - will be set explicitly
+	gzipTypes.insert("text/html");
 }
 
 LocationConfig::LocationConfig(const std::string &p)
 	: path(p),
+	  match(MATCH_PREFIX),
 	  root(""),
 	  autoindex(false),
+	  gzipStatic(false),
+	  brotliStatic(false),
+	  gzip(false),
+	  gzipCompLevel(GZIP_COMP_LEVEL),
+	  gzipMinLength(GZIP_MIN_LENGTH),
 	  clientMaxBodySize(0), // 0 means not set (inherit from server)
 	  uploadStore(""),
 	  redirect(""),
 	  redirectCode(0)
 {
 	// No default methods - will be set explicitly
+	gzipTypes.insert("text/html");
 }
 
 LocationConfig::~LocationConfig()
@@ -29,6 +45,12 @@ LocationConfig::~LocationConfig()
 }
 
 // Setters (Builder pattern)
+LocationConfig &LocationConfig::setMatch(LocationMatch m)
+{
+	match = m;
+	return *this;
+}
+
 LocationConfig &LocationConfig::setRoot(const std::string &r)
 {
 	root = r;
@@ -53,6 +75,56 @@ LocationConfig &LocationConfig::setAutoindex(bool enabled)
 	return *this;
 }
 
+LocationConfig &LocationConfig::setGzipStatic(bool enabled)
+{
+	gzipStatic = enabled;
+	return *this;
+}
+
+LocationConfig &LocationConfig::setBrotliStatic(bool enabled)
+{
+	brotliStatic = enabled;
+	return *this;
+}
+
+LocationConfig &LocationConfig::setExpires(const std::vector<ResponseHeader> &headers)
+{
+	expiresHeaders = headers;
+	renderResponseHeaders();
+	return *this;
+}
+
+LocationConfig &LocationConfig::addResponseHeader(const std::string &name, const std::string &value, bool always)
+{
+	addHeaders.push_back(ResponseHeader(name, value, always));
+	renderResponseHeaders();
+	return *this;
+}
+
+LocationConfig &LocationConfig::setGzip(bool enabled)
+{
+	gzip = enabled;
+	return *this;
+}
+
+LocationConfig &LocationConfig::setGzipCompLevel(int level)
+{
+	gzipCompLevel = level;
+	return *this;
+}
+
+LocationConfig &LocationConfig::setGzipMinLength(size_t length)
+{
+	gzipMinLength = length;
+	return *this;
+}
+
+LocationConfig &LocationConfig::addGzipType(const std::string &mimeType)
+{
+	gzipTypes.insert(mimeType);
+	return *this;
+}
+
 LocationConfig &LocationConfig::setClientMaxBodySize(size_t size)
 {
 	clientMaxBodySize = size;
@@ -78,12 +150,28 @@ LocationConfig &LocationConfig::setRedirect(const std::string &url, int code)
 	return *this;
 }
 
+LocationConfig &LocationConfig::setTryFiles(const std::vector<std::string> &entries)
+{
+	tryFiles = entries;
+	return *this;
+}
+
 // Getters
 std::string LocationConfig::getPath() const
 {
 	return path;
 }
 
+LocationMatch LocationConfig::getMatch() const
+{
+	return match;
+}
+
+bool LocationConfig::isRegex() const
+{
+	return match == MATCH_REGEX || match == MATCH_REGEX_ICASE;
+}
+
 std::string LocationConfig::getRoot() const
 {
 	return root;
@@ -104,6 +192,42 @@ bool LocationConfig::getAutoindex() const
 	return autoindex;
 }
 
+bool LocationConfig::getGzipStatic() const
+{
+	return gzipStatic;
+}
+
+bool LocationConfig::getBrotliStatic() const
+{
+	return brotliStatic;
+}
+
+bool LocationConfig::getGzip() const
+{
+	return gzip;
+}
+
+int LocationConfig::getGzipCompLevel() const
+{
+	return gzipCompLevel;
+}
+
+size_t LocationConfig::getGzipMinLength() const
+{
+	return gzipMinLength;
+}
+
+// contentType may carry parameters ("text/html; charset=utf-8"): only the type is matched
+bool LocationConfig::isGzipType(const std::string &contentType) const
+{
+	if (gzipTypes.count("*"))
+		return true;
+	std::string type = contentType.substr(0, contentType.find(';'));
+	while (!type.empty() && (type[type.size() - 1] == ' ' || type[type.size() - 1] == '\t'))
+		type.erase(type.size() - 1);
+	return gzipTypes.count(type) > 0;
+}
+
 size_t LocationConfig::getClientMaxBodySize() const
 {
 	return clientMaxBodySize;
@@ -122,6 +246,20 @@ std::string LocationConfig::getCgiPath(const std::string &extension) const
 	return "";
 }
 
+// Compares the extension in place against the (few) configured ones: nothing is allocated
+const std::string *LocationConfig::findCgiInterpreter(const std::string &filePath) const
+{
+	size_t dot = filePath.rfind('.');
+	if (dot == std::string::npos)
+		return NULL;
+	for (std::map<std::string, std::string>::const_iterator it = cgiHandlers.begin(); it != cgiHandlers.end(); ++it)
+	{
+		if (filePath.compare(dot, std::string::npos, it->first) == 0)
+			return &it->second;
+	}
+	return NULL;
+}
+
 std::string LocationConfig::getRedirect() const
 {
 	return redirect;
@@ -137,26 +275,72 @@ bool LocationConfig::hasRedirect() const
 	return !redirect.empty();
 }
 
+const std::vector<std::string> &LocationConfig::getTryFiles() const
+{
+	return tryFiles;
+}
+
 // Utility
+// Without 'always', only successful and redirect responses get them (nginx add_header semantics)
+void LocationConfig::applyResponseHeaders(HttpResponse &response) const
+{
+	int code = response.getStatusCode();
+	bool success = code == 200 || code == 201 || code == 204 || code == 206 || code == 301 || code == 302 ||
+				   code == 303 || code == 304 || code == 307 || code == 308;
+	response.addHeaderFragment(success ? successHeaders : alwaysHeaders);
+}
+
+// Done once per directive at config load; a name given twice (expires + add_header
+// Cache-Control) is simply sent as two lines, which list-valued headers allow
+void LocationConfig::renderResponseHeaders()
+{
+	successHeaders.clear();
+	alwaysHeaders.clear();
+	for (int pass = 0; pass < 2; pass++)
+	{
+		const std::vector<ResponseHeader> &headers = (pass == 0) ? expiresHeaders : addHeaders;
+		for (size_t i = 0; i < headers.size(); i++)
+		{
+			std::string line = headers[i].name + ": " + headers[i].value + "\r\n";
+			successHeaders += line;
+			if (headers[i].always)
+				alwaysHeaders += line;
+		}
+	}
+}
+
 void LocationConfig::clear()
 {
 	path = "/";
+	match = MATCH_PREFIX;
 	root.clear();
 	index.clear();
 	allowedMethods.clear();
 	allowedMethods.insert("GET");
 	allowedMethods.insert("HEAD");
 	autoindex = false;
+	gzipStatic = false;
+	brotliStatic = false;
+	gzip = false;
+	gzipCompLevel = GZIP_COMP_LEVEL;
+	gzipMinLength = GZIP_MIN_LENGTH;
+	gzipTypes.clear();
+	gzipTypes.insert("text/html");
 	uploadStore.clear();
 	cgiHandlers.clear();
 	redirect.clear();
 	redirectCode = 0;
+	expiresHeaders.clear();
+	addHeaders.clear();
+	tryFiles.clear();
+	successHeaders.clear();
+	alwaysHeaders.clear();
 }
 
 bool LocationConfig::isValid() const
 {
-	// Path must start with /
-	if (path.empty() || path[0] != '/')
+	// Path must start with / (a regex can be anything)
+	if (path.empty() || (!isRegex() && path[0] != '/'))
 		return false;
 
 	// If redirect is set, redirect code must be valid
@@ -0,0 +1,227 @@
+#include "config/LocationRouter.hpp"
+
+LocationRouter::LocationRouter(const ServerConfig &config)
+	: _hasPrefilter(false), _fallback("/")
+{
+	merge(_fallback, config);
+
+	const std::vector<LocationConfig> &locations = config.getLocations();
+	for (size_t i = 0; i < locations.size(); ++i)
+	{
+		_locations.push_back(locations[i]);
+		merge(_locations.back(), config);
+		if (locations[i].isRegex())
+			addRegex(&_locations.back());
+		else
+			insert(locations[i].getPath(), &_locations.back());
+	}
+	buildPrefilter();
+}
+
+LocationRouter::~LocationRouter()
+{
+	for (size_t i = 0; i < _regexes.size(); ++i)
+		regfree(&_regexes[i].regex);
+	if (_hasPrefilter)
+		regfree(&_prefilter);
+	for (size_t i = 0; i < _root.children.size(); ++i)
+		destroy(_root.children[i]);
+}
+
+const LocationConfig &LocationRouter::route(const StringView &path) const
+{
+	const Node *best = NULL;
+	const Node *node = &_root;
+	size_t pos = 0;
+	while (true)
+	{
+		if (pos == path.size() && node->exact)
+			return *node->exact;
+
+		// A prefix location ending here only counts on a component boundary
+		if (node->location && (node->anyTail || pos == path.size() || path[pos] == '/'))
+			best = node;
+		if (pos == path.size())
+			break;
+
+		const Node *next = NULL;
+		for (size_t i = 0; i < node->children.size(); ++i)
+		{
+			if (node->children[i]->label[0] == path[pos])
+			{
+				next = node->children[i];
+				break;
+			}
+		}
+		if (!next || path.substr(pos, next->label.size()) != StringView(next->label))
+			break;
+		pos += next->label.size();
+		node = next;
+	}
+
+	if (!best || !best->noRegex)
+	{
+		const LocationConfig *regex = matchRegex(path);
+		if (regex)
+			return *regex;
+	}
+	return best ? *best->location : _fallback;
+}
+
+// Fill in what the location leaves to the server: root, index files, client_max_body_size (0 = not set)
+// The resulting root and upload_store are opened as directory fds for every file access under them
+void LocationRouter::merge(LocationConfig &location, const ServerConfig &config)
+{
+	if (location.getRoot().empty())
+		location.setRoot(config.getRoot());
+	RootDirectories::getInstance()->add(location.getRoot());
+	if (!location.getUploadStore().empty())
+		RootDirectories::getInstance()->add(location.getUploadStore());
+
+	if (location.getIndex().empty())
+	{
+		const std::vector<std::string> &serverIndices = config.getIndex();
+		for (size_t i = 0; i < serverIndices.size(); ++i)
+			location.addIndex(serverIndices[i]);
+	}
+
+	if (location.getClientMaxBodySize() == 0)
+		location.setClientMaxBodySize(config.getClientMaxBodySize());
+}
+
+void LocationRouter::insert(const std::string &path, const LocationConfig *location)
+{
+	Node *node = &_root;
+	size_t pos = 0;
+	while (pos < path.size())
+	{
+		Node *child = NULL;
+		size_t slot = 0;
+		for (; slot < node->children.size(); ++slot)
+		{
+			if (node->children[slot]->label[0] == path[pos])
+			{
+				child = node->children[slot];
+				break;
+			}
+		}
+
+		if (!child)
+		{
+			child = new Node();
+			child->label = path.substr(pos);
+			node->children.push_back(child);
+			node = child;
+			break;
+		}
+
+		size_t common = 0;
+		while (common < child->label.size() && pos + common < path.size() && child->label[common] == path[pos + common])
+			++common;
+
+		// The path leaves the edge halfway: split it at the fork
+		if (common < child->label.size())
+		{
+			Node *fork = new Node();
+			fork->label = child->label.substr(0, common);
+			child->label.erase(0, common);
+			fork->children.push_back(child);
+			node->children[slot] = fork;
+			child = fork;
+		}
+		node = child;
+		pos += common;
+	}
+
+	// The same path twice: the first block wins, as with the old linear scan
+	if (location->getMatch() == MATCH_EXACT)
+	{
+		if (!node->exact)
+			node->exact = location;
+	}
+	else if (!node->location)
+	{
+		node->location = location;
+		node->anyTail = (path == "/");
+		node->noRegex = (location->getMatch() == MATCH_PREFIX_NO_REGEX);
+	}
+}
+
+void LocationRouter::addRegex(const LocationConfig *location)
+{
+	RegexRoute route;
+	int flags = REG_EXTENDED | REG_NOSUB | (location->getMatch() == MATCH_REGEX_ICASE ? REG_ICASE : 0);
+	if (regcomp(&route.regex, location->getPath().c_str(), flags) != 0)
+	{
+		// The parser compiled it once already, so this only happens to a hand-built config
+		Logger::warn("Ignoring location with an invalid regex: " + location->getPath());
+		return;
+	}
+	route.location = location;
+	_regexes.push_back(route);
+}
+
+// A superset of what the regexes match: each one is a group of the alternation,
+// and case-insensitive matching only ever accepts more. Not built when a pattern
+// has a backreference: the alternation renumbers its groups, so \1 would point elsewhere
+void LocationRouter::buildPrefilter()
+{
+	if (_regexes.size() < 2)
+		return;
+	for (size_t i = 0; i < _regexes.size(); ++i)
+	{
+		if (hasBackreference(_regexes[i].location->getPath()))
+			return;
+	}
+
+	std::string combined;
+	for (size_t i = 0; i < _regexes.size(); ++i)
+	{
+		if (i > 0)
+			combined += '|';
+		combined += "(" + _regexes[i].location->getPath() + ")";
+	}
+	_hasPrefilter = regcomp(&_prefilter, combined.c_str(), REG_EXTENDED | REG_NOSUB | REG_ICASE) == 0;
+}
+
+bool LocationRouter::hasBackreference(const std::string &pattern)
+{
+	for (size_t i = 0; i + 1 < pattern.size(); ++i)
+	{
+		if (pattern[i] != '\\')
+			continue;
+		if (pattern[i + 1] >= '1' && pattern[i + 1] <= '9')
+			return true;
+		++i; // An escaped character, "\\" included
+	}
+	return false;
+}
+
+const LocationConfig *LocationRouter::matchRegex(const StringView &path) const
+{
+	if (_regexes.empty() || (_hasPrefilter && !matches(_prefilter, path)))
+		return NULL;
+
+	for (size_t i = 0; i < _regexes.size(); ++i)
+	{
+		if (matches(_regexes[i].regex, path))
+			return _regexes[i].location;
+	}
+	return NULL;
+}
+
+// REG_STARTEND: the bounds come from pmatch[0], so the path needs no NUL-terminated copy
+bool LocationRouter::matches(const regex_t &regex, const StringView &path)
+{
+	regmatch_t bounds[1];
+	bounds[0].rm_so = 0;
+	bounds[0].rm_eo = static_cast<regoff_t>(path.size());
+	return regexec(&regex, path.data(), 1, bounds, REG_STARTEND) == 0;
+}
+
+void LocationRouter::destroy(Node *node)
+{
+	for (size_t i = 0; i < node->children.size(); ++i)
+		destroy(node->children[i]);
+	delete node;
+}
@@ -4,7 +4,13 @@ ServerConfig::ServerConfig()
 	: host(DEFAULT_HOST),			   // Listen on all interfaces by default
 	  port(DEFAULT_PORT),			   // Default port
 	  root(DEFAULT_ROOT),			   // Default web root
-	  clientMaxBodySize(MAX_BODY_SIZE) // 1MB default
+	  clientMaxBodySize(MAX_BODY_SIZE), // 1MB default
+	  maxRequestLine(MAX_REQUEST_LINE),
+	  maxHeaderLine(MAX_HEADER_LINE),
+	  maxHeaderCount(MAX_HEADER_COUNT),
+	  maxHeaderSize(MAX_HEADER_SIZE),
+	  staticCacheSize(0),
+	  staticCacheMaxFile(STATIC_CACHE_MAX_FILE)
 {
 	// Default index files
 	index.push_back(DEFAULT_INDEX);
@@ -55,6 +61,61 @@ ServerConfig &ServerConfig::setClientMaxBodySize(size_t size)
 	return *this;
 }
 
+ServerConfig &ServerConfig::setMaxRequestLine(size_t size)
+{
+	maxRequestLine = size;
+	return *this;
+}
+
+ServerConfig &ServerConfig::setMaxHeaderLine(size_t size)
+{
+	maxHeaderLine = size;
+	return *this;
+}
+
+ServerConfig &ServerConfig::setMaxHeaderCount(size_t count)
+{
+	maxHeaderCount = count;
+	return *this;
+}
+
+ServerConfig &ServerConfig::setMaxHeaderSize(size_t size)
+{
+	maxHeaderSize = size;
+	return *this;
+}
+
+ServerConfig &ServerConfig::setOpenFileCache(size_t maxEntries, time_t inactive)
+{
+	openFileCache.maxEntries = maxEntries;
+	openFileCache.inactive = inactive;
+	return *this;
+}
+
+ServerConfig &ServerConfig::setOpenFileCacheValid(time_t valid)
+{
+	openFileCache.valid = valid;
+	return *this;
+}
+
+ServerConfig &ServerConfig::setOpenFileCacheErrors(bool enabled)
+{
+	openFileCache.errors = enabled;
+	return *this;
+}
+
+ServerConfig &ServerConfig::setStaticCacheSize(size_t size)
+{
+	staticCacheSize = size;
+	return *this;
+}
+
+ServerConfig &ServerConfig::setStaticCacheMaxFile(size_t size)
+{
+	staticCacheMaxFile = size;
+	return *this;
+}
+
 ServerConfig &ServerConfig::addErrorPage(int statusCode, const std::string &path)
 {
 	errorPages[statusCode] = path;
@@ -98,6 +159,41 @@ size_t ServerConfig::getClientMaxBodySize() const
 	return clientMaxBodySize;
 }
 
+size_t ServerConfig::getMaxRequestLine() const
+{
+	return maxRequestLine;
+}
+
+size_t ServerConfig::getMaxHeaderLine() const
+{
+	return maxHeaderLine;
+}
+
+size_t ServerConfig::getMaxHeaderCount() const
+{
+	return maxHeaderCount;
+}
+
+size_t ServerConfig::getMaxHeaderSize() const
+{
+	return maxHeaderSize;
+}
+
+const OpenFileCacheConfig &ServerConfig::getOpenFileCache() const
+{
+	return openFileCache;
+}
+
+size_t ServerConfig::getStaticCacheSize() const
+{
+	return staticCacheSize;
+}
+
+size_t ServerConfig::getStaticCacheMaxFile() const
+{
+	return staticCacheMaxFile;
+}
+
 std::string ServerConfig::getErrorPage(int statusCode) const
 {
 	std::map<int, std::string>::const_iterator it = errorPages.find(statusCode);
@@ -106,35 +202,14 @@ std::string ServerConfig::getErrorPage(int statusCode) const
 	return "";
 }
 
-const std::vector<LocationConfig> &ServerConfig::getLocations() const
+const std::map<int, std::string> &ServerConfig::getErrorPages() const
 {
-	return locations;
+	return errorPages;
 }
 
-const LocationConfig *ServerConfig::matchLocation(const std::string &uri) const
-{
-	const LocationConfig *bestMatch = NULL;
-	size_t bestLen = 0;
-
-	for (size_t i = 0; i < locations.size(); ++i)
-	{
-		const std::string &path = locations[i].getPath();
-		// Check if URI starts with path
-		if (uri.compare(0, path.length(), path) == 0)
-		{
-			// Ensure full path component match (e.g. /img matches /img/foo but not /images)
-			if (path == "/" || uri.length() == path.length() || uri[path.length()] == '/')
-			{
-				// Longest prefix match
-				if (path.length() > bestLen || bestMatch == NULL)
-				{
-					bestMatch = &locations[i];
-					bestLen = path.length();
-				}
-			}
-		}
-	}
-	return bestMatch;
+const std::vector<LocationConfig> &ServerConfig::getLocations() const
+{
+	return locations;
 }
 
 // Utility
@@ -149,6 +224,13 @@ void ServerConfig::clear()
 	index.push_back(DEFAULT_INDEX);
 	index.push_back("index.htm");
 	clientMaxBodySize = MAX_BODY_SIZE;
+	maxRequestLine = MAX_REQUEST_LINE;
+	maxHeaderLine = MAX_HEADER_LINE;
+	maxHeaderCount = MAX_HEADER_COUNT;
+	maxHeaderSize = MAX_HEADER_SIZE;
+	openFileCache = OpenFileCacheConfig();
+	staticCacheSize = 0;
+	staticCacheMaxFile = STATIC_CACHE_MAX_FILE;
 	errorPages.clear();
 	locations.clear();
 }
@@ -19,6 +19,30 @@ Token Tokenizer::readWord()
 	return Token(TOKEN_WORD, value, _line);
 }
 
+// Read a quoted value ("..." or '...') as one word; \ escapes the next character
+Token Tokenizer::readQuoted()
+{
+	char quote = _input[_pos++];
+	int line = _line;
+	std::string value;
+
+	while (_pos < _input.length() && _input[_pos] != quote)
+	{
+		if (_input[_pos] == '\\' && _pos + 1 < _input.length())
+			_pos++;
+		if (_input[_pos] == '\n')
+			_line++;
+		value += _input[_pos++];
+	}
+
+	// Unterminated string
+	if (_pos >= _input.length())
+		return Token(TOKEN_ERROR, std::string(1, quote), line);
+
+	_pos++; // Closing quote
+	return Token(TOKEN_WORD, value, line);
+}
+
 // Read the next token from input
 Token Tokenizer::readToken()
 {
@@ -62,6 +86,8 @@ Token Tokenizer::readToken()
 	// Word token (identifier, keyword, value)
 	if (isWordChar(c))
 		return readWord();
+	if (c == '"' || c == '\'')
+		return readQuoted();
 
 	// Unknown character - error
 	_pos++;
@@ -17,24 +17,17 @@ bool CgiHandler::hasCgiPipe(int pipeFd) const
     return _pipeToClient.count(pipeFd) > 0;
 }
 
-void CgiHandler::startCgi(ClientConnection *client, const HttpRequest &request, const HttpResponse &response, Poller &poller)
+bool CgiHandler::startCgi(ClientConnection *client, const std::string &script, const std::string &interpreter, Poller &poller)
 {
     // Reset CGI state for new execution
     client->getCgiState() = CgiState();
     client->getCgiState().startTime = time(NULL);
 
     CgiExecutor executor;
-    executor.start(request, response.getCgiScriptPath(), response.getCgiInterpreterPath(), client->getCgiState());
+    executor.start(client->getParser().getRequest(), script, interpreter, client->getCgiState());
 
     if (!client->getCgiState().active)
-    {
-        Logger::error("Failed to start CGI");
-        client->appendToWriteBuffer(StatusCodes::createErrorResponse(HTTP_INTERNAL_SERVER_ERROR, "CGI Start Failed").build());
-        // Assuming poller is accessible or we return status to update poller
-        // Here we need to update poller outside or pass it in. We passed it in.
-        poller.modifyFd(client->getFd(), EPOLLOUT);
-        return;
-    }
+        return false;
 
     CgiState &state = client->getCgiState();
     int clientFd = client->getFd();
@@ -46,7 +39,7 @@ void CgiHandler::startCgi(ClientConnection *client, const HttpRequest &request,
         {
             Logger::error("Failed to add CGI input pipe to poller");
             cleanupCgi(client, poller);
-            return;
+            return false;
         }
         else
             _pipeToClient[state.pipeIn[1]] = clientFd;
@@ -59,13 +52,14 @@ void CgiHandler::startCgi(ClientConnection *client, const HttpRequest &request,
         {
             Logger::error("Failed to add CGI output pipe to poller");
             cleanupCgi(client, poller);
-            return;
+            return false;
         }
         else
             _pipeToClient[state.pipeOut[0]] = clientFd;
     }
 
     Logger::info(Logger::connMsg("CGI Started asynchronously", clientFd));
+    return true;
 }
 
 void CgiHandler::cleanupCgi(ClientConnection *client, Poller &poller)
@@ -93,12 +87,12 @@ void CgiHandler::cleanupCgi(ClientConnection *client, Poller &poller)
     }
 }
 
-void CgiHandler::handleCgiRead(int pipeFd, ClientConnection *client, Poller &poller)
+CgiProgress CgiHandler::handleCgiRead(int pipeFd, ClientConnection *client, Poller &poller, HttpResponse &response)
 {
     CgiState &state = client->getCgiState();
 
     if (state.pipeOut[0] != pipeFd)
-        return;
+        return CGI_RUNNING;
 
     char buffer[4096];
     ssize_t bytes = read(pipeFd, buffer, sizeof(buffer));
@@ -110,39 +104,41 @@ void CgiHandler::handleCgiRead(int pipeFd, ClientConnection *client, Poller &pol
         else if (bytes == 0)
             Logger::debug("CGI output pipe closed (EOF)");
 
-        handleCgiHangup(pipeFd, client, poller);
-        return;
+        return handleCgiHangup(pipeFd, client, poller, response);
     }
 
     state.responseBuffer.append(buffer, bytes);
+    return CGI_RUNNING;
 }
 
-void CgiHandler::handleCgiWrite(int pipeFd, ClientConnection *client, Poller &poller)
+CgiProgress CgiHandler::handleCgiWrite(int pipeFd, ClientConnection *client, Poller &poller, HttpResponse &response)
 {
     CgiState &state = client->getCgiState();
 
     if (state.pipeIn[1] != pipeFd)
-        return;
+        return CGI_RUNNING;
 
-    const std::string &body = state.requestBody;
-    if (!body.empty())
+    size_t remaining = state.requestBody ? state.requestBody->size() - state.bodyWritten : 0;
+    if (remaining > 0)
     {
-        ssize_t bytes = write(pipeFd, body.c_str(), body.size());
+        ssize_t bytes = write(pipeFd, state.requestBody->data() + state.bodyWritten, remaining);
         
         if (bytes == -1)
         {
             Logger::error("CGI write error");
-            handleCgiHangup(pipeFd, client, poller);
-            return;
+            return handleCgiHangup(pipeFd, client, poller, response);
         }
-        // Don't erase anything, will retry or handle on next event
+        // Don't advance anything, will retry or handle on next event
         else if (bytes == 0)
             Logger::debug("CGI write returned 0, pipe may be closed");
         else if (bytes > 0)
-            state.requestBody.erase(0, bytes);
+        {
+            state.bodyWritten += bytes;
+            remaining -= bytes;
+        }
     }
 
-    if (state.requestBody.empty())
+    if (remaining == 0)
     {
         poller.removeFd(pipeFd);
         _pipeToClient.erase(pipeFd);
@@ -150,9 +146,10 @@ void CgiHandler::handleCgiWrite(int pipeFd, ClientConnection *client, Poller &po
         state.pipeIn[1] = -1;
         Logger::debug("CGI input closed");
     }
+    return CGI_RUNNING;
 }
 
-void CgiHandler::handleCgiHangup(int pipeFd, ClientConnection *client, Poller &poller)
+CgiProgress CgiHandler::handleCgiHangup(int pipeFd, ClientConnection *client, Poller &poller, HttpResponse &response)
 {
     CgiState &state = client->getCgiState();
 
@@ -172,42 +169,40 @@ void CgiHandler::handleCgiHangup(int pipeFd, ClientConnection *client, Poller &p
     }
 
     // If output pipe is closed, we assume CGI is done sending data
-    if (state.pipeOut[0] == -1)
-    {
-        state.active = false;
+    if (state.pipeOut[0] != -1)
+        return CGI_RUNNING;
 
-        // Ensure child process is terminated and reaped
-        int status;
-        pid_t wpid = waitpid(state.pid, &status, WNOHANG);
+    state.active = false;
 
-        if (wpid == 0)
-        {
-            kill(state.pid, SIGKILL);
-            waitpid(state.pid, &status, 0);
-        }
+    // Ensure child process is terminated and reaped
+    int status;
+    pid_t wpid = waitpid(state.pid, &status, WNOHANG);
 
-        if (WIFEXITED(status) && WEXITSTATUS(status) != 0)
-        {
-            Logger::error("CGI process exited with error code");
-            client->appendToWriteBuffer(StatusCodes::createErrorResponse(HTTP_BAD_GATEWAY, "Bad Gateway").build());
-        }
-        else if (WIFSIGNALED(status))
-        {
-            Logger::error("CGI process killed by signal");
-            client->appendToWriteBuffer(StatusCodes::createErrorResponse(HTTP_INTERNAL_SERVER_ERROR, "Internal Server Error").build());
-        }
-        else
-        {
-            Logger::info("CGI Finished, processing response");
-            processCgiResponse(client);
-        }
+    if (wpid == 0)
+    {
+        kill(state.pid, SIGKILL);
+        waitpid(state.pid, &status, 0);
+    }
 
-        client->getParser().reset();
-        poller.modifyFd(client->getFd(), EPOLLOUT);
+    if (WIFEXITED(status) && WEXITSTATUS(status) != 0)
+    {
+        Logger::error("CGI process exited with error code");
+        response = StatusCodes::createErrorResponse(HTTP_BAD_GATEWAY, "Bad Gateway");
+        return CGI_FAILED;
+    }
+    if (WIFSIGNALED(status))
+    {
+        Logger::error("CGI process killed by signal");
+        response = StatusCodes::createErrorResponse(HTTP_INTERNAL_SERVER_ERROR, "Internal Server Error");
+        return CGI_FAILED;
     }
+
+    Logger::info("CGI Finished, processing response");
+    response = processCgiResponse(client);
+    return CGI_DONE;
 }
 
-void CgiHandler::processCgiResponse(ClientConnection *client)
+HttpResponse CgiHandler::processCgiResponse(ClientConnection *client)
 {
     CgiState &state = client->getCgiState();
     HttpResponse response;
@@ -276,10 +271,11 @@ void CgiHandler::processCgiResponse(ClientConnection *client)
         response.addHeader("Content-Type", "text/plain"); // Default fallback
     }
 
-    client->appendToWriteBuffer(response.build());
+    // Location headers and gzip are added with the rest of the response pipeline
+    return response;
 }
 
-void CgiHandler::handleTimeout(ClientConnection *client, Poller &poller)
+HttpResponse CgiHandler::handleTimeout(ClientConnection *client, Poller &poller)
 {
     Logger::error(Logger::connMsg("CGI Timeout detected (Infinite Loop)", client->getFd()));
 
@@ -289,13 +285,5 @@ void CgiHandler::handleTimeout(ClientConnection *client, Poller &poller)
     // Send 508 Error Response
     // 508 Loop Detected is WebDAV, typically 504 Gateway Timeout makes more sense for CGI timeout, 
     // but user asked for "Loop detected error". 508 is "Loop Detected".
-    HttpResponse response = StatusCodes::createErrorResponse(HTTP_LOOP_DETECTED, "Loop Detected"); 
-
-    std::string rawResponse = response.build();
-    rawResponse += "\r\n";
-    client->appendToWriteBuffer(rawResponse);
-    
-    // Reset parser for next request
-    client->getParser().reset();
-    poller.modifyFd(client->getFd(), EPOLLOUT);
+    return StatusCodes::createErrorResponse(HTTP_LOOP_DETECTED, "Loop Detected");
 }
@@ -1,7 +1,8 @@
 #include "core/ClientConnection.hpp"
 
 ClientConnection::ClientConnection(int fd, size_t maxBodySize)
-    : _fd(fd), _shouldClose(false)
+    : _fd(fd), _fileFd(-1), _fileOffset(0), _fileRemaining(0), _gzip(NULL), _gzipInputPos(0), _shouldClose(false),
+      _location(NULL)
 {
     _parser.setMaxBodySize(maxBodySize);
     Logger::debug(Logger::fdMsg("ClientConnection created", fd));
@@ -10,6 +11,8 @@ ClientConnection::ClientConnection(int fd, size_t maxBodySize)
 ClientConnection::~ClientConnection()
 {
     Logger::debug(Logger::fdMsg("ClientConnection destroyed, closing socket", _fd));
+    closeFileBody();
+    delete _gzip;
     close(_fd);
 }
 
@@ -43,6 +46,128 @@ void ClientConnection::clearWriteBuffer()
     _writeBuffer.clear();
 }
 
+void ClientConnection::setFileBody(int fd, off_t offset, size_t length)
+{
+    closeFileBody();
+    if (length == 0)
+    {
+        close(fd);
+        return;
+    }
+    _fileFd = fd;
+    _fileOffset = offset;
+    _fileRemaining = length;
+}
+
+void ClientConnection::setFileSegments(const std::vector<FileSegment> &segments, const std::string &trailer)
+{
+    _fileSegments.assign(segments.begin(), segments.end());
+    _fileTrailer = trailer;
+}
+
+bool ClientConnection::hasFileBody() const
+{
+    return _fileFd != -1;
+}
+
+ssize_t ClientConnection::sendFileBody()
+{
+    // The kernel copies page cache -> socket and advances _fileOffset; nothing passes through user space
+    ssize_t bytes = sendfile(_fd, _fileFd, &_fileOffset, _fileRemaining);
+    if (bytes <= 0)
+        return bytes;
+
+    _fileRemaining -= bytes;
+    if (_fileRemaining > 0)
+        return bytes;
+
+    // Next range of a multipart/byteranges body: its part headers are written before its bytes
+    while (_fileRemaining == 0 && !_fileSegments.empty())
+    {
+        _writeBuffer += _fileSegments.front().before;
+        _fileOffset = _fileSegments.front().offset;
+        _fileRemaining = _fileSegments.front().length;
+        _fileSegments.pop_front();
+    }
+    if (_fileRemaining == 0)
+    {
+        _writeBuffer += _fileTrailer;
+        closeFileBody();
+    }
+    return bytes;
+}
+
+void ClientConnection::closeFileBody()
+{
+    if (_fileFd == -1)
+        return;
+    close(_fileFd);
+    _fileFd = -1;
+    _fileOffset = 0;
+    _fileRemaining = 0;
+    _fileSegments.clear();
+    _fileTrailer.clear();
+}
+
+void ClientConnection::setGzipBody(GzipFilter *filter, const std::string &body)
+{
+    delete _gzip;
+    _gzip = filter;
+    _gzipInput = body;
+    _gzipInputPos = 0;
+}
+
+bool ClientConnection::hasGzipBody() const
+{
+    return _gzip != NULL;
+}
+
+bool ClientConnection::fillGzipBody()
+{
+    // deflate may keep a small slice to itself: feed it until a chunk comes out or the body ends
+    size_t queued = _writeBuffer.size();
+    while (_gzip && _writeBuffer.size() == queued)
+    {
+        char slice[GZIP_CHUNK_SIZE];
+        const char *data;
+        size_t length;
+        bool finish;
+
+        if (_fileFd != -1)
+        {
+            // pread: the fd may be a dup sharing its offset with the open file cache
+            ssize_t n = pread(_fileFd, slice, std::min(sizeof(slice), _fileRemaining), _fileOffset);
+            if (n <= 0)
+                return false; // 0: the file shrank under us
+            _fileOffset += n;
+            _fileRemaining -= n;
+            data = slice;
+            length = n;
+            finish = (_fileRemaining == 0);
+            if (finish)
+                closeFileBody();
+        }
+        else
+        {
+            data = _gzipInput.data() + _gzipInputPos;
+            length = std::min(static_cast<size_t>(GZIP_CHUNK_SIZE), _gzipInput.size() - _gzipInputPos);
+            _gzipInputPos += length;
+            finish = (_gzipInputPos == _gzipInput.size());
+        }
+
+        if (!_gzip->write(data, length, finish, _writeBuffer))
+            return false;
+        if (_gzip->isFinished())
+        {
+            delete _gzip;
+            _gzip = NULL;
+            _gzipInput.clear();
+            _gzipInputPos = 0;
+        }
+    }
+    return true;
+}
+
 HttpParser &ClientConnection::getParser()
 {
     return _parser;
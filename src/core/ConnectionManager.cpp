@@ -1,7 +1,9 @@
 #include "core/ConnectionManager.hpp"
 
-ConnectionManager::ConnectionManager(RequestHandler &requestHandler, CgiHandler &cgiHandler)
-    : _requestHandler(requestHandler), _cgiHandler(cgiHandler)
+ConnectionManager::ConnectionManager(RequestHandler &requestHandler, CgiHandler &cgiHandler, ResponseCache &responseCache,
+                                     ErrorPageCache &errorPageCache, ThreadPool &threadPool)
+    : _defaultRouter((ServerConfig())), _requestHandler(requestHandler), _cgiHandler(cgiHandler),
+      _responseCache(responseCache), _errorPageCache(errorPageCache), _threadPool(threadPool)
 {
 }
 
@@ -10,11 +12,15 @@ ConnectionManager::~ConnectionManager()
     // Note: Clients should be cleaned up via closeAllConnections or in destructor
     for (std::map<int, ClientConnection *>::iterator it = _clients.begin(); it != _clients.end(); ++it)
         delete it->second;
+    for (std::map<int, LocationRouter *>::iterator it = _routers.begin(); it != _routers.end(); ++it)
+        delete it->second;
 }
 
 void ConnectionManager::addServerConfig(int serverFd, const ServerConfig &config)
 {
     _serverConfigs[serverFd] = config;
+    delete _routers[serverFd];
+    _routers[serverFd] = new LocationRouter(config);
 }
 
 ClientConnection *ConnectionManager::getClient(int fd)
@@ -35,27 +41,21 @@ void ConnectionManager::acceptNewConnection(int serverFd, ServerSocket *server,
     if (clientFd < 0)
         return;
 
+    // Server-wide body limit until a request is routed; routeRequest() then
+    // narrows it to the matched location before any body byte is read
     size_t maxBodySize = MAX_BODY_SIZE;
     if (_serverConfigs.find(serverFd) != _serverConfigs.end())
-    {
-        const ServerConfig &config = _serverConfigs[serverFd];
-        maxBodySize = config.getClientMaxBodySize();
-
-        // Check loops for all locations to find the largest body size allowed
-        // This ensures the parser doesn't reject a large request that might be valid for a specific location
-        const std::vector<LocationConfig> &locations = config.getLocations();
-        for (size_t i = 0; i < locations.size(); ++i)
-        {
-            size_t locSize = locations[i].getClientMaxBodySize();
-            if (locSize > maxBodySize)
-                maxBodySize = locSize;
-        }
-    }
+        maxBodySize = _serverConfigs[serverFd].getClientMaxBodySize();
 
     ClientConnection *client = new ClientConnection(clientFd, maxBodySize);
     _clients[clientFd] = client;
     _clientToServer[clientFd] = serverFd;
 
+    // Bound the request head before any byte of it is buffered
+    const ServerConfig &config = resolveConfig(clientFd);
+    client->getParser().setHeaderLimits(config.getMaxRequestLine(), config.getMaxHeaderLine(),
+                                        config.getMaxHeaderCount(), config.getMaxHeaderSize());
+
     // Add client to poller (watch for EPOLLIN - incoming data)
     // EPOLLIN value is defined in CgiHandler but standard in sys/epoll.h or Poller.hpp
     if (!poller.addFd(clientFd, EPOLLIN))
@@ -92,9 +92,17 @@ void ConnectionManager::handleRead(int clientFd, Poller &poller)
 
     ClientConnection *client = _clients[clientFd];
 
-    // Feed the data chunk to the HTTP parser
-    std::string chunk(buffer, n);
-    client->getParser().parse(chunk);
+    // Feed the data chunk to the HTTP parser (appended straight into its buffer)
+    client->getParser().parse(buffer, n);
+    handleParsed(clientFd, client, poller);
+}
+
+// Act on what the parser has reached, from a read or from pipelined bytes already buffered
+void ConnectionManager::handleParsed(int clientFd, ClientConnection *client, Poller &poller)
+{
+    // Headers just completed: route before reading the body
+    if (client->getParser().headersComplete() && !routeRequest(clientFd, client, poller))
+        return;
 
     if (client->getParser().isComplete())
         processRequest(clientFd, client, poller);
@@ -113,33 +121,62 @@ const ServerConfig &ConnectionManager::resolveConfig(int clientFd)
     return defaultConfig;
 }
 
-LocationConfig ConnectionManager::resolveLocation(const HttpRequest &request, const ServerConfig &config)
+const LocationRouter &ConnectionManager::resolveRouter(int clientFd)
 {
-    const LocationConfig *locationPtr = config.matchLocation(request.getUri());
+    std::map<int, LocationRouter *>::const_iterator it = _routers.find(_clientToServer[clientFd]);
+    if (it != _routers.end())
+        return *it->second;
+    return _defaultRouter;
+}
 
-    LocationConfig location;
-    if (locationPtr)
-        location = *locationPtr;
+bool ConnectionManager::routeRequest(int clientFd, ClientConnection *client, Poller &poller)
+{
+    HttpParser &parser = client->getParser();
+    HttpRequest &request = parser.getRequest();
+    const LocationConfig &location = resolveRouter(clientFd).route(request.getPath());
+    client->setLocation(&location);
+
+    // Expect is only meaningful for HTTP/1.1; 100-continue is the only expectation defined
+    StringView expect;
+    if (request.getVersion() == "HTTP/1.1")
+        expect = request.getHeader(HDR_EXPECT);
+    bool wantsContinue = expect.iequals("100-continue");
+
+    HttpResponse rejection;
+    bool accepted = true;
+    if (!expect.empty() && !wantsContinue)
+    {
+        Logger::warn(Logger::connMsg("Unsupported expectation: " + expect.str(), clientFd));
+        rejection = StatusCodes::createErrorResponse(HTTP_EXPECTATION_FAILED, "Expectation Failed");
+        accepted = false;
+    }
     else
-        location = LocationConfig("/");
-
-    // Inherit root from server config if not specified in location
-    if (location.getRoot().empty())
-        location.setRoot(config.getRoot());
+        accepted = _requestHandler.checkRequest(request, location, parser.getContentLength(), rejection);
 
-    // Inherit index files from server config if not specified in location
-    if (location.getIndex().empty())
+    if (!accepted)
     {
-        const std::vector<std::string> &serverIndices = config.getIndex();
-        for (size_t i = 0; i < serverIndices.size(); ++i)
-            location.addIndex(serverIndices[i]);
+        // The body (if any) was never read; drop the connection instead of parsing it as a request
+        if (parser.expectsBody())
+            client->setShouldClose(true);
+        applyCustomErrorPage(rejection, clientFd);
+        sendResponse(client, rejection, poller);
+        return false;
     }
 
-    // Inherit clientMaxBodySize from server config (0 means not set)
-    if (location.getClientMaxBodySize() == 0)
-        location.setClientMaxBodySize(config.getClientMaxBodySize());
+    // Chunked bodies have no declared size, so the parser enforces the location limit as they stream in
+    size_t maxBodySize = location.getClientMaxBodySize();
+    parser.setMaxBodySize(maxBodySize > 0 ? maxBodySize : static_cast<size_t>(-1));
 
-    return location;
+    // Tell the client to go ahead; it is queued ahead of the final response
+    if (wantsContinue && parser.expectsBody())
+    {
+        Logger::debug(Logger::connMsg("Sending 100 Continue", clientFd));
+        client->appendToWriteBuffer("HTTP/1.1 100 Continue\r\n\r\n");
+        poller.modifyFd(clientFd, EPOLLOUT);
+    }
+
+    parser.resume();
+    return true;
 }
 
 void ConnectionManager::processRequest(int clientFd, ClientConnection *client, Poller &poller)
@@ -147,21 +184,185 @@ void ConnectionManager::processRequest(int clientFd, ClientConnection *client, P
     Logger::info(Logger::connMsg("HTTP request parsing complete", clientFd));
 
     HttpRequest &request = client->getParser().getRequest();
-    const ServerConfig &config = resolveConfig(clientFd);
-    LocationConfig location = resolveLocation(request, config);
+    const LocationConfig &location = client->getLocation();
+
+    // Hot static files: the serialized response goes straight into the write buffer
+    std::string cacheKey;
+    if (responseCacheKey(request, location, cacheKey) &&
+        _responseCache.lookup(cacheKey, request.getMethod() == HTTP_HEAD, client->getWriteBuffer()))
+    {
+        Logger::debug(Logger::connMsg("Response cache hit: " + cacheKey, clientFd));
+        if (request.getHeader(HDR_CONNECTION).iequals("close"))
+            client->setShouldClose(true);
+        client->getParser().startNextRequest();
+        poller.modifyFd(clientFd, EPOLLOUT);
+        return;
+    }
 
     HttpResponse response = _requestHandler.handleRequest(request, location);
 
-    if (response.isCgi())
+    if (response.getPending())
     {
-        _cgiHandler.startCgi(client, request, response, poller);
+        startPending(clientFd, response.getPending(), poller);
         return;
     }
 
-    applyCustomErrorPage(response, config);
-    if (request.getHeader("Connection") == "close")
+    finishRequest(clientFd, client, response, cacheKey, poller);
+}
+
+// Error page, per-location headers, compression, then out to the client
+// (errorPages is false for a response an upstream such as a CGI script made itself)
+void ConnectionManager::finishRequest(int clientFd, ClientConnection *client, HttpResponse &response,
+                                      const std::string &cacheKey, Poller &poller, bool errorPages)
+{
+    HttpRequest &request = client->getParser().getRequest();
+    const LocationConfig &location = client->getLocation();
+
+    if (errorPages)
+        applyCustomErrorPage(response, clientFd);
+    location.applyResponseHeaders(response);
+
+    // Compressed on the fly from here on, unless a cached gzipped copy replaced the body
+    GzipFilter *gzip = GzipFilter::apply(response, request, location);
+
+    if (!cacheKey.empty() && request.getMethod() == HTTP_GET)
+    {
+        std::string rootDir = location.getRoot().empty() ? DEFAULT_ROOT : location.getRoot();
+        _responseCache.store(cacheKey, rootDir + request.getPath().str(), response);
+    }
+
+    if (request.getHeader(HDR_CONNECTION).iequals("close"))
         client->setShouldClose(true);
-    sendResponse(client, response, poller);
+    sendResponse(client, response, poller, gzip);
+}
+
+// The connection is parked until the response is complete: the request and its parser
+// stay as they are, and nothing pipelined behind it is read. Only the peer closing is
+// watched for, so a client that gives up stops its CGI at once
+void ConnectionManager::startPending(int clientFd, PendingResponse *pending, Poller &poller)
+{
+    _pending[clientFd] = pending;
+    poller.modifyFd(clientFd, EPOLLRDHUP);
+
+    LoopContext context(*this, poller);
+    pending->start(clientFd, context); // May complete (and delete it) right away
+}
+
+void ConnectionManager::completePending(int clientFd, HttpResponse &response, Poller &poller, bool errorPages)
+{
+    std::map<int, PendingResponse *>::iterator it = _pending.find(clientFd);
+    if (it == _pending.end())
+        return;
+    delete it->second;
+    _pending.erase(it);
+
+    finishRequest(clientFd, _clients[clientFd], response, std::string(), poller, errorPages);
+}
+
+void ConnectionManager::handleTaskCompletions(Poller &poller)
+{
+    std::vector<ThreadPool::Job> done;
+    _threadPool.collect(done);
+
+    for (size_t i = 0; i < done.size(); ++i)
+    {
+        int clientFd = done[i].clientFd;
+        BlockingTask *task = done[i].task;
+
+        // The client went away meanwhile (its fd may even belong to someone else now):
+        // the work is done, but nobody is waiting for the answer
+        std::map<int, PendingResponse *>::iterator it = _pending.find(clientFd);
+        if (it == _pending.end() || it->second != task)
+        {
+            delete task;
+            continue;
+        }
+
+        HttpResponse response = task->complete();
+        completePending(clientFd, response, poller);
+    }
+}
+
+void ConnectionManager::handleCgiEvent(const PollEvent &ev, Poller &poller)
+{
+    int clientFd = _cgiHandler.getClientFd(ev.fd);
+    ClientConnection *client = getClient(clientFd);
+    if (!client)
+        return;
+
+    HttpResponse response;
+    CgiProgress progress = CGI_RUNNING;
+    if (ev.readable)
+        progress = _cgiHandler.handleCgiRead(ev.fd, client, poller, response);
+    else if (ev.writable)
+        progress = _cgiHandler.handleCgiWrite(ev.fd, client, poller, response);
+    else if (ev.error || ev.hangup)
+        progress = _cgiHandler.handleCgiHangup(ev.fd, client, poller, response);
+
+    // The script's own error statuses go out as it wrote them; the server's get the error pages
+    if (progress != CGI_RUNNING)
+        completePending(clientFd, response, poller, progress == CGI_FAILED);
+}
+
+bool ConnectionManager::LoopContext::submit(int clientFd, BlockingTask *task)
+{
+    return _manager._threadPool.submit(clientFd, task);
+}
+
+bool ConnectionManager::LoopContext::startCgi(int clientFd, const std::string &script, const std::string &interpreter)
+{
+    ClientConnection *client = _manager.getClient(clientFd);
+    return client && _manager._cgiHandler.startCgi(client, script, interpreter, _poller);
+}
+
+void ConnectionManager::LoopContext::stopCgi(int clientFd)
+{
+    ClientConnection *client = _manager.getClient(clientFd);
+    if (client && client->getCgiState().active)
+        _manager._cgiHandler.cleanupCgi(client, _poller);
+}
+
+void ConnectionManager::LoopContext::complete(int clientFd, HttpResponse &response)
+{
+    _manager.completePending(clientFd, response, _poller);
+}
+
+// Requests GetHandler/HeadHandler would answer from a file alone; key = root + path
+bool ConnectionManager::responseCacheKey(const HttpRequest &request, const LocationConfig &location, std::string &key)
+{
+    if (!_responseCache.isEnabled())
+        return false;
+    if (request.getMethod() != HTTP_GET && request.getMethod() != HTTP_HEAD)
+        return false;
+    if (location.hasRedirect() || request.getPath() == "/session_test")
+        return false;
+    if (request.hasHeader(HDR_RANGE))
+        return false; // A part of the file, not the cached whole
+    if (request.hasHeader(HDR_IF_NONE_MATCH) || request.hasHeader(HDR_IF_MODIFIED_SINCE))
+        return false; // Likely a 304: the handler answers it without touching the file
+
+    std::string path = request.getPath().str();
+    if (location.findCgiInterpreter(path))
+        return false;
+
+    // try_files: an entry only follows the file it holds, so the request path must be the first
+    // candidate; a file found after it depends on names the entry doesn't watch, and a fallback
+    // served in its place is never stored (ResponseCache::store wants root + request path)
+    const std::vector<std::string> &tryFiles = location.getTryFiles();
+    if (!tryFiles.empty() && tryFiles[0] != "$uri")
+        return false;
+
+    std::string rootDir = location.getRoot();
+    if (rootDir.empty())
+        rootDir = DEFAULT_ROOT;
+    key = rootDir + path;
+
+    // gzip_static / brotli_static / gzip: the codings this client may be served are part of the key
+    if (location.getBrotliStatic() && acceptsEncoding(request.getHeader(HDR_ACCEPT_ENCODING), "br"))
+        key += "|br";
+    if ((location.getGzipStatic() || location.getGzip()) && acceptsEncoding(request.getHeader(HDR_ACCEPT_ENCODING), "gzip"))
+        key += "|gz";
+    return true;
 }
 
 void ConnectionManager::processParseError(int clientFd, ClientConnection *client, Poller &poller)
@@ -170,15 +371,29 @@ void ConnectionManager::processParseError(int clientFd, ClientConnection *client
 
     int code = HTTP_BAD_REQUEST;
     std::string msg = "Bad Request";
-    if (client->getParser().getErrorMessage() == "Payload Too Large")
+    const std::string &error = client->getParser().getErrorMessage();
+    if (error == "Payload Too Large")
     {
         code = HTTP_PAYLOAD_TOO_LARGE;
         msg = "Payload Too Large";
     }
+    else if (error == "URI Too Long")
+    {
+        code = HTTP_URI_TOO_LONG;
+        msg = error;
+    }
+    else if (error == "Request Header Fields Too Large")
+    {
+        code = HTTP_REQUEST_HEADER_FIELDS_TOO_LARGE;
+        msg = error;
+    }
+
+    // The rest of an oversized head or body is still in flight; don't parse it as a new request
+    if (code != HTTP_BAD_REQUEST)
+        client->setShouldClose(true);
 
-    const ServerConfig &config = resolveConfig(clientFd);
     HttpResponse response = StatusCodes::createErrorResponse(code, msg);
-    applyCustomErrorPage(response, config);
+    applyCustomErrorPage(response, clientFd);
     sendResponse(client, response, poller);
 }
 
@@ -190,29 +405,64 @@ void ConnectionManager::handleWrite(int clientFd, Poller &poller)
     ClientConnection *c = _clients[clientFd];
     const std::string &data = c->getWriteBuffer();
 
-    ssize_t bytes = send(clientFd, data.c_str(), data.size(), 0);
-    if (bytes <= 0)
+    if (!data.empty())
     {
-        if (bytes == 0)
-            Logger::debug(Logger::connMsg("Client closed connection during write", clientFd));
-        else
-            Logger::warn(Logger::connMsg("Client write failed", clientFd));
+        // With a file body to follow, let the kernel pack the headers into its first segment
+        int flags = (c->hasFileBody() || c->hasGzipBody()) ? MSG_MORE : 0;
+        ssize_t bytes = send(clientFd, data.c_str(), data.size(), flags);
+        if (bytes <= 0)
+        {
+            if (bytes == 0)
+                Logger::debug(Logger::connMsg("Client closed connection during write", clientFd));
+            else
+                Logger::warn(Logger::connMsg("Client write failed", clientFd));
 
-        handleDisconnect(clientFd, poller);
-        return;
+            handleDisconnect(clientFd, poller);
+            return;
+        }
+
+        std::ostringstream os;
+        os << "Sent " << bytes << " bytes to client";
+        Logger::debug(Logger::connMsg(os.str(), clientFd));
+
+        if ((size_t)bytes < data.size())
+        {
+            c->getWriteBuffer().erase(0, bytes);
+            Logger::debug(Logger::connMsg("Partial write, data remaining", clientFd));
+            return;
+        }
+        c->clearWriteBuffer();
     }
 
-    std::ostringstream os;
-    os << "Sent " << bytes << " bytes to client";
-    Logger::debug(Logger::connMsg(os.str(), clientFd));
+    // gzip body: one slice compressed per EPOLLOUT, sent by the next one
+    if (c->hasGzipBody())
+    {
+        if (!c->fillGzipBody())
+        {
+            // Headers are out already: all we can do is cut the response short
+            Logger::warn(Logger::connMsg("gzip body failed", clientFd));
+            handleDisconnect(clientFd, poller);
+            return;
+        }
+        if (!c->getWriteBuffer().empty())
+            return;
+    }
 
-    if ((size_t)bytes < data.size())
+    // Static file body: as much as the socket takes per EPOLLOUT, straight from the page cache
+    if (c->hasFileBody())
     {
-        c->getWriteBuffer().erase(0, bytes);
-        Logger::debug(Logger::connMsg("Partial write, data remaining", clientFd));
-        return;
+        ssize_t bytes = c->sendFileBody();
+        if (bytes <= 0)
+        {
+            // 0 means the file shrank under us: the promised Content-Length can't be met
+            Logger::warn(Logger::connMsg("Client file write failed", clientFd));
+            handleDisconnect(clientFd, poller);
+            return;
+        }
+        // Still sending, or a multi-range part header / trailer got queued
+        if (c->hasFileBody() || !c->getWriteBuffer().empty())
+            return;
     }
-    c->clearWriteBuffer();
 
     // Close connection if requested (Connection: close)
     if (c->shouldClose())
@@ -224,6 +474,11 @@ void ConnectionManager::handleWrite(int clientFd, Poller &poller)
 
     // Change back to monitor for read events
     poller.modifyFd(clientFd, EPOLLIN);
+
+    // A pipelined request that arrived with the last one is answered now that this response is out
+    HttpParser &parser = c->getParser();
+    if (parser.headersComplete() || parser.isComplete() || parser.hasError())
+        handleParsed(clientFd, c, poller);
 }
 
 void ConnectionManager::handleDisconnect(int fd, Poller &poller)
@@ -237,9 +492,16 @@ void ConnectionManager::handleDisconnect(int fd, Poller &poller)
 
     ClientConnection *client = _clients[fd];
 
-    // Cleanup CGI if active
-    if (client->getCgiState().active)
-        _cgiHandler.cleanupCgi(client, poller);
+    // Stop whatever its response was waiting for (the CGI is killed, a worker's task is
+    // deleted when it comes back)
+    std::map<int, PendingResponse *>::iterator pending = _pending.find(fd);
+    if (pending != _pending.end())
+    {
+        LoopContext context(*this, poller);
+        if (pending->second->cancel(fd, context))
+            delete pending->second;
+        _pending.erase(pending);
+    }
 
     _clients.erase(fd);
     _clientToServer.erase(fd);
@@ -269,17 +531,32 @@ void ConnectionManager::checkCgiTimeouts(Poller &poller)
         if (state.active)
         {
             if (difftime(now, state.startTime) > CGI_TIMEOUT_SEC)
-                _cgiHandler.handleTimeout(client, poller);
+            {
+                HttpResponse response = _cgiHandler.handleTimeout(client, poller);
+                completePending(it->first, response, poller);
+            }
         }
     }
 }
 
-void ConnectionManager::applyCustomErrorPage(HttpResponse &response, const ServerConfig &config)
+void ConnectionManager::applyCustomErrorPage(HttpResponse &response, int clientFd)
 {
     int code = response.getStatusCode();
     if (code < 400)
         return;
 
+    // Preloaded at startup: the body is copied from memory
+    const ErrorPageCache::Page *page = _errorPageCache.find(_clientToServer[clientFd], code);
+    if (page)
+    {
+        response.setBody(page->body)
+            .addHeader("Content-Type", page->contentType)
+            .addHeader("Content-Length", page->contentLength);
+        Logger::debug("Serving preloaded error page: " + page->path);
+        return;
+    }
+
+    const ServerConfig &config = resolveConfig(clientFd);
     std::string errorPagePath = config.getErrorPage(code);
     if (errorPagePath.empty())
         return;
@@ -290,37 +567,59 @@ void ConnectionManager::applyCustomErrorPage(HttpResponse &response, const Serve
         fullPath = fullPath.substr(0, fullPath.size() - 1);
     fullPath += errorPagePath;
 
-    if (!FileHandler::fileExists(fullPath) || !FileHandler::isReadable(fullPath))
+    OpenFileCache *cache = OpenFileCache::getInstance();
+    FileInfo info;
+    if (!cache->lookup(fullPath, info) || info.isDirectory)
     {
         Logger::warn("Custom error page not found or not readable: " + fullPath);
         return;
     }
 
-    std::string content = FileHandler::readFile(fullPath);
-    if (content.empty() && FileHandler::getFileSize(fullPath) > 0)
+    // Sent with sendfile() like any static file
+    int fd = cache->acquire(fullPath, info);
+    if (fd < 0)
     {
-        Logger::warn("Failed to read custom error page: " + fullPath);
+        Logger::warn("Failed to open custom error page: " + fullPath);
         return;
     }
 
-    response.setBody(content);
-    response.addHeader("Content-Type", MimeTypes::getMimeType(fullPath));
-    response.addHeader("Content-Length", toString(content.size()));
+    response.setFileBody(fd, 0, info.size, fullPath);
+    response.addHeader("Content-Type", info.mimeType);
+    response.addHeader("Content-Length", toString(info.size));
     Logger::info("Serving custom error page: " + fullPath);
 }
 
-void ConnectionManager::sendResponse(ClientConnection *client, HttpResponse &response, Poller &poller)
+void ConnectionManager::sendResponse(ClientConnection *client, HttpResponse &response, Poller &poller, GzipFilter *gzip)
 {
     if (response.getHeader("Connection") == "close")
         client->setShouldClose(true);
 
-    std::string rawResponse = response.build();
-    rawResponse += "\r\n";
-
-    client->appendToWriteBuffer(rawResponse);
+    if (gzip)
+    {
+        // Head now, the body is compressed chunk by chunk in handleWrite()
+        response.appendHead(client->getWriteBuffer());
+        if (response.hasFileBody())
+            client->setFileBody(response.getFileFd(), response.getFileOffset(), response.getFileLength());
+        client->setGzipBody(gzip, response.getBody());
+    }
+    else if (response.hasFileBody())
+    {
+        // Only the head is buffered; handleWrite() streams the file after it
+        response.appendHead(client->getWriteBuffer());
+        client->appendToWriteBuffer(response.getFilePrefix());
+        client->setFileBody(response.getFileFd(), response.getFileOffset(), response.getFileLength());
+        client->setFileSegments(response.getFileSegments(), response.getFileTrailer());
+    }
+    else
+    {
+        // Exactly head + body: a stray CRLF would be read as the start of the next response
+        // on a kept-alive connection (fatal after a bodiless 304)
+        response.appendTo(client->getWriteBuffer());
+    }
 
-    // Reset parser for next request
-    client->getParser().reset();
+    // Next request: bytes pipelined behind this one are kept and parsed; they are
+    // acted on once this response is written (handleWrite)
+    client->getParser().startNextRequest();
 
     // Change to monitor for write events
     poller.modifyFd(client->getFd(), EPOLLOUT);
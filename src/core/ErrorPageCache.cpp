@@ -0,0 +1,161 @@
+#include "core/ErrorPageCache.hpp"
+
+ErrorPageCache::ErrorPageCache()
+	: _inotifyFd(-1)
+{
+}
+
+ErrorPageCache::~ErrorPageCache()
+{
+	if (_inotifyFd != -1)
+		close(_inotifyFd);
+}
+
+bool ErrorPageCache::enable(Poller &poller)
+{
+	if (_inotifyFd != -1)
+		return true;
+
+	// A page that is never refreshed would outlive edits: no inotify, no preloading
+	_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (_inotifyFd < 0)
+	{
+		Logger::warn(Logger::errnoMsg("Error pages are read from disk: inotify_init1 failed"));
+		return false;
+	}
+	if (!poller.addFd(_inotifyFd, EPOLLIN))
+	{
+		Logger::warn("Error pages are read from disk: cannot watch the inotify fd");
+		close(_inotifyFd);
+		_inotifyFd = -1;
+		return false;
+	}
+	return true;
+}
+
+int ErrorPageCache::getFd() const
+{
+	return _inotifyFd;
+}
+
+void ErrorPageCache::load(int serverFd, const ServerConfig &config)
+{
+	if (_inotifyFd == -1)
+		return;
+
+	// Error page paths are relative to the server root
+	std::string root = config.getRoot();
+	if (!root.empty() && root[root.size() - 1] == '/')
+		root.erase(root.size() - 1);
+
+	const std::map<int, std::string> &errorPages = config.getErrorPages();
+	for (std::map<int, std::string>::const_iterator it = errorPages.begin(); it != errorPages.end(); ++it)
+	{
+		std::string path = root + it->second;
+		std::map<std::string, Page>::iterator found = _pages.find(path);
+		if (found == _pages.end())
+		{
+			// Watch first: a change after this point is always seen, even one racing the read below
+			size_t slash = path.rfind('/');
+			std::string dir = (slash == std::string::npos) ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+			int wd = watchDirectory(dir);
+			if (wd < 0)
+				continue;
+
+			Page &page = _pages[path];
+			page.path = path;
+			page.contentType = MimeTypes::getMimeType(path);
+			page.loaded = false;
+			page.wd = wd;
+			page.name = path.substr(slash == std::string::npos ? 0 : slash + 1);
+			read(page);
+			found = _pages.find(path);
+		}
+		_byServer[serverFd][it->first] = &found->second;
+	}
+}
+
+const ErrorPageCache::Page *ErrorPageCache::find(int serverFd, int code) const
+{
+	std::map<int, std::map<int, const Page *> >::const_iterator server = _byServer.find(serverFd);
+	if (server == _byServer.end())
+		return NULL;
+	std::map<int, const Page *>::const_iterator it = server->second.find(code);
+	if (it == server->second.end() || !it->second->loaded)
+		return NULL;
+	return it->second;
+}
+
+void ErrorPageCache::handleEvents()
+{
+	// inotify_event carries a variable-length name: read into suitably aligned storage
+	long buffer[1024];
+	ssize_t bytes;
+	while ((bytes = ::read(_inotifyFd, buffer, sizeof(buffer))) > 0)
+	{
+		const char *p = reinterpret_cast<const char *>(buffer);
+		const char *end = p + bytes;
+		while (p < end)
+		{
+			const struct inotify_event *ev = reinterpret_cast<const struct inotify_event *>(p);
+			p += sizeof(struct inotify_event) + ev->len;
+
+			// An overflow may have hidden any change: read everything again
+			bool all = (ev->mask & IN_Q_OVERFLOW) != 0;
+			for (std::map<std::string, Page>::iterator it = _pages.begin(); it != _pages.end(); ++it)
+			{
+				if (all || (it->second.wd == ev->wd && (ev->len == 0 || it->second.name == ev->name)))
+					read(it->second);
+			}
+		}
+	}
+}
+
+// Replace the page's body with the file's current content; a failed read leaves it unloaded
+void ErrorPageCache::read(Page &page)
+{
+	size_t size;
+	int fd = FileHandler::openRegularFile(page.path, size);
+	if (fd < 0)
+	{
+		if (page.loaded)
+			Logger::warn("Custom error page not found or not readable: " + page.path);
+		page.loaded = false;
+		return;
+	}
+
+	std::string body(size, '\0');
+	size_t done = 0;
+	while (done < size)
+	{
+		ssize_t n = ::read(fd, &body[done], size - done);
+		if (n <= 0)
+			break;
+		done += n;
+	}
+	close(fd);
+	body.resize(done);
+
+	page.body.swap(body);
+	page.contentLength = toString(page.body.size());
+	page.loaded = true;
+	Logger::debug("Error page loaded: " + page.path + " (" + page.contentLength + " bytes)");
+}
+
+int ErrorPageCache::watchDirectory(const std::string &dir)
+{
+	std::map<std::string, int>::iterator found = _watches.find(dir);
+	if (found != _watches.end())
+		return found->second;
+
+	int wd = inotify_add_watch(_inotifyFd, dir.c_str(),
+							   IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+								   IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+	if (wd < 0)
+	{
+		Logger::warn(Logger::errnoMsg("Error pages: cannot watch " + dir));
+		return -1;
+	}
+	_watches[dir] = wd;
+	return wd;
+}
@@ -3,13 +3,18 @@
 EventLoop::EventLoop()
     : _running(true),
       _requestHandler(new RequestHandler()),
-      _connManager(*_requestHandler, _cgiHandler)
+      _connManager(*_requestHandler, _cgiHandler, _responseCache, _errorPageCache, _threadPool)
 {
     if (!_poller.isValid())
     {
         Logger::error("Failed to create Poller (epoll)");
         _running = false;
     }
+    else
+    {
+        _errorPageCache.enable(_poller);
+        _threadPool.start(THREAD_POOL_SIZE, THREAD_POOL_QUEUE, _poller);
+    }
 
     Logger::debug("EventLoop initialized with Poller and RequestHandler");
 }
@@ -32,6 +37,7 @@ void EventLoop::addServer(ServerSocket *server, const ServerConfig &config)
 {
     _servers[server->getFd()] = server;
     _connManager.addServerConfig(server->getFd(), config);
+    _errorPageCache.load(server->getFd(), config);
 
     // Add server socket to poller (watch for EPOLLIN - incoming connections)
     if (!_poller.addFd(server->getFd(), EPOLLIN))
@@ -43,6 +49,11 @@ void EventLoop::addServer(ServerSocket *server, const ServerConfig &config)
     Logger::debug(Logger::fdMsg("Server added to event loop", server->getFd()));
 }
 
+bool EventLoop::enableResponseCache(size_t budget, size_t maxFileSize)
+{
+    return _responseCache.enable(budget, maxFileSize, _poller);
+}
+
 void EventLoop::run()
 {
     Logger::info("Event loop started with epoll. Press Ctrl+C to stop.");
@@ -52,6 +63,9 @@ void EventLoop::run()
         // Check for active CGI scripts running too long
         _connManager.checkCgiTimeouts(_poller);
 
+        // Close cached files nobody asked for lately
+        OpenFileCache::getInstance()->expireInactive(time(NULL));
+
         // Wait for events using Poller (epoll-based)
         int n = _poller.wait(1000); // 1s timeout to allow periodic tasks
 
@@ -97,22 +111,30 @@ void EventLoop::run()
                 continue;
             }
 
-            // 3. Handle CGI Pipes
-            if (_cgiHandler.hasCgiPipe(ev.fd))
+            // 3. Files under a cached response changed
+            if (ev.fd == _responseCache.getFd())
+            {
+                _responseCache.handleEvents();
+                continue;
+            }
+
+            // 4. An error_page file changed
+            if (ev.fd == _errorPageCache.getFd())
             {
-                int clientFd = _cgiHandler.getClientFd(ev.fd);
-                ClientConnection *client = _connManager.getClient(clientFd);
-
-                if (client)
-                {
-                    if (ev.readable)
-                        _cgiHandler.handleCgiRead(ev.fd, client, _poller);
-                    else if (ev.writable)
-                        _cgiHandler.handleCgiWrite(ev.fd, client, _poller);
-                    else if ((ev.error || ev.hangup))
-                        _cgiHandler.handleCgiHangup(ev.fd, client, _poller);
-                }
+                _errorPageCache.handleEvents();
+                continue;
             }
+
+            // 5. Blocking file operations finished on the thread pool
+            if (ev.fd == _threadPool.getFd())
+            {
+                _connManager.handleTaskCompletions(_poller);
+                continue;
+            }
+
+            // 6. Handle CGI Pipes
+            if (_cgiHandler.hasCgiPipe(ev.fd))
+                _connManager.handleCgiEvent(ev, _poller);
         }
     }
 
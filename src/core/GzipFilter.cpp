@@ -0,0 +1,162 @@
+#include "core/GzipFilter.hpp"
+
+GzipFilter::GzipFilter(int level)
+	: _finished(false), _level(level)
+{
+	std::memset(&_stream, 0, sizeof(_stream));
+}
+
+GzipFilter::~GzipFilter()
+{
+	deflateEnd(&_stream);
+}
+
+bool GzipFilter::init()
+{
+	// windowBits 15 + 16: gzip wrapper (header + CRC32 trailer) instead of raw zlib
+	return deflateInit2(&_stream, _level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+}
+
+GzipFilter *GzipFilter::apply(HttpResponse &response, const HttpRequest &request, const LocationConfig &location)
+{
+	if (!location.getGzip())
+		return NULL;
+
+	int status = response.getStatusCode();
+	if (status < HTTP_OK || status == HTTP_NO_CONTENT || status == HTTP_PARTIAL_CONTENT || status == HTTP_NOT_MODIFIED)
+		return NULL;
+	if (!response.getHeader("Content-Encoding").empty() || !location.isGzipType(response.getHeader("Content-Type")))
+		return NULL;
+
+	// Compressible either way: caches between us and the client must key on Accept-Encoding
+	response.addVary("Accept-Encoding");
+	if (!acceptsEncoding(request.getHeader(HDR_ACCEPT_ENCODING), "gzip"))
+		return NULL;
+
+	// HEAD: the headers GET would send for the same file, with no body to compress
+	bool head = request.getMethod() == HTTP_HEAD;
+	size_t length;
+	if (head)
+		length = std::strtoul(response.getHeader("Content-Length").c_str(), NULL, 10);
+	else
+		length = response.hasFileBody() ? response.getFileLength() : response.getBody().size();
+	if (length < location.getGzipMinLength())
+		return NULL;
+
+	// A whole small static file: its gzipped body may already sit in the open file cache
+	int level = location.getGzipCompLevel();
+	OpenFileCache *cache = OpenFileCache::getInstance();
+	FileInfo info;
+	bool cacheable = false;
+	if (head && !response.getFilePath().empty() && length <= GZIP_CACHE_MAX_FILE && cache->isEnabled())
+	{
+		std::string compressed;
+		if (cache->lookup(response.getFilePath(), info) && info.size == length &&
+			cache->getCompressed(response.getFilePath(), info, level, compressed))
+		{
+			response.removeHeader("Accept-Ranges")
+				.setContentEncoding("gzip")
+				.addHeader("Content-Length", toString(compressed.size()));
+			return NULL;
+		}
+	}
+	else if (response.hasFileBody() && response.getFileOffset() == 0 && length <= GZIP_CACHE_MAX_FILE && cache->isEnabled())
+	{
+		struct stat st;
+		if (fstat(response.getFileFd(), &st) == 0 && static_cast<size_t>(st.st_size) == length)
+		{
+			info.size = length;
+			info.mtime = st.st_mtime;
+			info.inode = st.st_ino;
+			cacheable = true;
+		}
+
+		std::string compressed;
+		if (cacheable && cache->getCompressed(response.getFilePath(), info, level, compressed))
+		{
+			close(response.getFileFd());
+			std::string path = response.getFilePath();
+			response.setBody(compressed)
+				.setFilePath(path)
+				.removeHeader("Accept-Ranges")
+				.setContentEncoding("gzip")
+				.addHeader("Content-Length", toString(compressed.size()));
+			return NULL;
+		}
+	}
+
+	// Streaming needs chunked transfer coding, which HTTP/1.0 clients don't know
+	if (request.getVersion() == "HTTP/1.0")
+		return NULL;
+
+	if (head)
+	{
+		response.setContentEncoding("gzip").setChunked().removeHeader("Accept-Ranges");
+		return NULL;
+	}
+
+	GzipFilter *filter = new GzipFilter(level);
+	if (!filter->init())
+	{
+		Logger::error("gzip: deflateInit2 failed, sending the response uncompressed");
+		delete filter;
+		return NULL;
+	}
+	if (cacheable)
+	{
+		filter->_cachePath = response.getFilePath();
+		filter->_cacheInfo = info;
+	}
+
+	// Byte ranges of the compressed body aren't offered (a Range request got an uncompressed 206)
+	response.setContentEncoding("gzip").setChunked().removeHeader("Accept-Ranges");
+	return filter;
+}
+
+bool GzipFilter::write(const char *data, size_t length, bool finish, std::string &out)
+{
+	if (_finished)
+		return true;
+
+	_stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+	_stream.avail_in = static_cast<uInt>(length);
+
+	// Z_NO_FLUSH lets deflate hold small slices back until it has a block worth emitting
+	std::string chunk;
+	unsigned char buffer[GZIP_CHUNK_SIZE];
+	int ret;
+	do
+	{
+		_stream.next_out = buffer;
+		_stream.avail_out = sizeof(buffer);
+		ret = deflate(&_stream, finish ? Z_FINISH : Z_NO_FLUSH);
+		if (ret == Z_STREAM_ERROR)
+			return false;
+		chunk.append(reinterpret_cast<char *>(buffer), sizeof(buffer) - _stream.avail_out);
+	} while (_stream.avail_out == 0);
+
+	if (!chunk.empty())
+	{
+		std::ostringstream size;
+		size << std::hex << chunk.size();
+		out += size.str() + "\r\n" + chunk + "\r\n";
+		if (!_cachePath.empty())
+			_compressed += chunk;
+	}
+
+	if (finish)
+	{
+		if (ret != Z_STREAM_END)
+			return false;
+		_finished = true;
+		out += "0\r\n\r\n";
+		if (!_cachePath.empty())
+			OpenFileCache::getInstance()->storeCompressed(_cachePath, _cacheInfo, _level, _compressed);
+	}
+	return true;
+}
+
+bool GzipFilter::isFinished() const
+{
+	return _finished;
+}
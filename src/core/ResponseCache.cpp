@@ -0,0 +1,229 @@
+#include "core/ResponseCache.hpp"
+#include "utils/OpenFileCache.hpp"
+
+ResponseCache::ResponseCache()
+	: _inotifyFd(-1), _budget(0), _maxFileSize(0), _used(0)
+{
+}
+
+ResponseCache::~ResponseCache()
+{
+	clear();
+	if (_inotifyFd != -1)
+		close(_inotifyFd);
+}
+
+bool ResponseCache::enable(size_t budget, size_t maxFileSize, Poller &poller)
+{
+	if (budget == 0 || _inotifyFd != -1)
+		return false;
+
+	// Without change notifications a cached page could never be refreshed: no inotify, no cache
+	_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (_inotifyFd < 0)
+	{
+		Logger::warn(Logger::errnoMsg("Response cache disabled: inotify_init1 failed"));
+		return false;
+	}
+	if (!poller.addFd(_inotifyFd, EPOLLIN))
+	{
+		Logger::warn("Response cache disabled: cannot watch the inotify fd");
+		close(_inotifyFd);
+		_inotifyFd = -1;
+		return false;
+	}
+
+	_budget = budget;
+	_maxFileSize = maxFileSize;
+	return true;
+}
+
+bool ResponseCache::isEnabled() const
+{
+	return _inotifyFd != -1;
+}
+
+int ResponseCache::getFd() const
+{
+	return _inotifyFd;
+}
+
+bool ResponseCache::lookup(const std::string &key, bool headOnly, std::string &out)
+{
+	std::map<std::string, EntryList::iterator>::iterator found = _index.find(key);
+	if (found == _index.end())
+		return false;
+
+	EntryList::iterator it = found->second;
+	_entries.splice(_entries.begin(), _entries, it); // Move to front (LRU)
+	out.append(it->response, 0, it->statusLength);
+	out += HttpResponse::dateServerHeaders();
+	out.append(it->response, it->statusLength, (headOnly ? it->headLength : it->response.size()) - it->statusLength);
+	return true;
+}
+
+// "file.css.gz" / "file.css.br" -> "file.css"
+static std::string stripCompressedSuffix(const std::string &name)
+{
+	if (name.size() > 3 && (name.compare(name.size() - 3, 3, ".gz") == 0 || name.compare(name.size() - 3, 3, ".br") == 0))
+		return name.substr(0, name.size() - 3);
+	return name;
+}
+
+void ResponseCache::store(const std::string &key, const std::string &file, const HttpResponse &response)
+{
+	// A file segment, or an in-memory body made from a file (a cached gzipped copy);
+	// a body still to be streamed through gzip has no known length yet
+	if (!isEnabled() || response.getStatusCode() != HTTP_OK || response.isChunked())
+		return;
+
+	size_t length = response.hasFileBody() ? response.getFileLength() : response.getBody().size();
+	const std::string &path = response.getFilePath();
+	if (length > _maxFileSize || path.empty() || _index.count(key))
+		return;
+
+	// Only the file the request path names (or its .gz / .br sibling): an entry is dropped
+	// when that one name changes, so a response picked through other names (an index
+	// file, a try_files candidate) would outlive a change to them
+	if (path != file && stripCompressedSuffix(path) != file)
+		return;
+
+	// Watch first: a change after this point is always seen, even one racing the read below
+	size_t slash = path.rfind('/');
+	std::string dir = (slash == std::string::npos) ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+	int wd = watchDirectory(dir);
+	if (wd < 0)
+		return;
+
+	Entry entry;
+	entry.key = key;
+	entry.response = response.buildHead(false);
+	entry.headLength = entry.response.size();
+	entry.statusLength = entry.response.find("\r\n") + 2;
+	entry.wd = wd;
+	entry.name = path.substr(slash == std::string::npos ? 0 : slash + 1);
+	entry.path = path;
+
+	size_t cost = entry.headLength + length + key.size();
+	if (cost > _budget)
+		return;
+
+	if (!response.hasFileBody())
+		entry.response += response.getBody();
+
+	// pread leaves the fd's offset alone, so the same fd is still sent with sendfile() afterwards
+	entry.response.resize(entry.headLength + length);
+	size_t done = 0;
+	while (response.hasFileBody() && done < length)
+	{
+		ssize_t n = pread(response.getFileFd(), &entry.response[entry.headLength + done], length - done,
+						  response.getFileOffset() + done);
+		if (n <= 0)
+			return;
+		done += n;
+	}
+
+	while (_used + cost > _budget && !_entries.empty())
+		evict(--_entries.end());
+
+	_entries.push_front(entry);
+	_index[key] = _entries.begin();
+	_used += cost;
+	Logger::debug("Response cache: stored " + key + " (" + toString(cost) + " bytes)");
+}
+
+void ResponseCache::handleEvents()
+{
+	// inotify_event carries a variable-length name: read into suitably aligned storage
+	long buffer[1024];
+	ssize_t bytes;
+	while ((bytes = read(_inotifyFd, buffer, sizeof(buffer))) > 0)
+	{
+		const char *p = reinterpret_cast<const char *>(buffer);
+		const char *end = p + bytes;
+		while (p < end)
+		{
+			const struct inotify_event *ev = reinterpret_cast<const struct inotify_event *>(p);
+			p += sizeof(struct inotify_event) + ev->len;
+
+			if (ev->mask & IN_Q_OVERFLOW)
+			{
+				Logger::warn("Response cache: inotify queue overflow, dropping everything");
+				while (!_entries.empty())
+					evict(_entries.begin());
+			}
+			else if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))
+			{
+				invalidate(ev->wd, ""); // The directory itself went away
+				if (ev->mask & IN_IGNORED)
+				{
+					for (std::map<std::string, int>::iterator it = _watches.begin(); it != _watches.end(); ++it)
+					{
+						if (it->second == ev->wd)
+						{
+							_watches.erase(it);
+							break;
+						}
+					}
+				}
+			}
+			else if (ev->len > 0)
+				invalidate(ev->wd, ev->name);
+		}
+	}
+}
+
+void ResponseCache::clear()
+{
+	while (!_entries.empty())
+		evict(_entries.begin());
+	for (std::map<std::string, int>::iterator it = _watches.begin(); it != _watches.end(); ++it)
+		inotify_rm_watch(_inotifyFd, it->second);
+	_watches.clear();
+}
+
+int ResponseCache::watchDirectory(const std::string &dir)
+{
+	std::map<std::string, int>::iterator found = _watches.find(dir);
+	if (found != _watches.end())
+		return found->second;
+
+	int wd = inotify_add_watch(_inotifyFd, dir.c_str(),
+							   IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+								   IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+	if (wd < 0)
+	{
+		Logger::warn(Logger::errnoMsg("Response cache: cannot watch " + dir));
+		return -1;
+	}
+	_watches[dir] = wd;
+	return wd;
+}
+
+// Drop the entries of file name in watched directory wd (every entry of wd if name is empty)
+// A file and its .gz / .br siblings count as one: any of them changing alters what
+// gzip_static / brotli_static would serve for the others
+void ResponseCache::invalidate(int wd, const std::string &name)
+{
+	std::string base = stripCompressedSuffix(name);
+
+	EntryList::iterator it = _entries.begin();
+	while (it != _entries.end())
+	{
+		EntryList::iterator current = it++;
+		if (current->wd != wd || (!name.empty() && stripCompressedSuffix(current->name) != base))
+			continue;
+
+		// The open file cache may still hold the replaced file: refresh it too
+		OpenFileCache::getInstance()->invalidate(current->path);
+		Logger::debug("Response cache: " + current->key + " changed on disk");
+		evict(current);
+	}
+}
+
+void ResponseCache::evict(EntryList::iterator it)
+{
+	_used -= it->response.size() + it->key.size();
+	_index.erase(it->key);
+	_entries.erase(it);
+}
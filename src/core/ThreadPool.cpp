@@ -0,0 +1,142 @@
+#include "core/ThreadPool.hpp"
+
+ThreadPool::ThreadPool()
+	: _maxQueue(0), _stopping(false), _eventFd(-1)
+{
+	pthread_mutex_init(&_mutex, NULL);
+	pthread_cond_init(&_cond, NULL);
+}
+
+ThreadPool::~ThreadPool()
+{
+	pthread_mutex_lock(&_mutex);
+	_stopping = true;
+	pthread_cond_broadcast(&_cond);
+	pthread_mutex_unlock(&_mutex);
+
+	// A worker finishes the task it holds: a write is never cut in the middle
+	for (size_t i = 0; i < _threads.size(); ++i)
+		pthread_join(_threads[i], NULL);
+
+	for (size_t i = 0; i < _queue.size(); ++i)
+		delete _queue[i].task;
+	for (size_t i = 0; i < _done.size(); ++i)
+		delete _done[i].task;
+	if (_eventFd != -1)
+		close(_eventFd);
+	pthread_cond_destroy(&_cond);
+	pthread_mutex_destroy(&_mutex);
+}
+
+bool ThreadPool::start(size_t threads, size_t maxQueue, Poller &poller)
+{
+	if (_eventFd != -1 || threads == 0)
+		return false;
+
+	_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (_eventFd < 0)
+	{
+		Logger::warn(Logger::errnoMsg("Blocking file operations run on the event loop: eventfd failed"));
+		return false;
+	}
+	if (!poller.addFd(_eventFd, EPOLLIN))
+	{
+		Logger::warn("Blocking file operations run on the event loop: cannot watch the eventfd");
+		close(_eventFd);
+		_eventFd = -1;
+		return false;
+	}
+	_maxQueue = maxQueue;
+
+	// Threads inherit the signal mask they are created with
+	sigset_t all, old;
+	sigfillset(&all);
+	pthread_sigmask(SIG_BLOCK, &all, &old);
+	for (size_t i = 0; i < threads; ++i)
+	{
+		pthread_t thread;
+		if (pthread_create(&thread, NULL, &ThreadPool::workerMain, this) != 0)
+			break;
+		_threads.push_back(thread);
+	}
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+	if (_threads.empty())
+	{
+		Logger::warn("Blocking file operations run on the event loop: no worker thread could be started");
+		poller.removeFd(_eventFd);
+		close(_eventFd);
+		_eventFd = -1;
+		return false;
+	}
+	Logger::debug("Thread pool started: " + toString(_threads.size()) + " workers");
+	return true;
+}
+
+int ThreadPool::getFd() const
+{
+	return _eventFd;
+}
+
+bool ThreadPool::submit(int clientFd, BlockingTask *task)
+{
+	if (_threads.empty())
+		return false;
+
+	pthread_mutex_lock(&_mutex);
+	bool queued = _queue.size() < _maxQueue;
+	if (queued)
+	{
+		Job job;
+		job.clientFd = clientFd;
+		job.task = task;
+		_queue.push_back(job);
+		pthread_cond_signal(&_cond);
+	}
+	pthread_mutex_unlock(&_mutex);
+	return queued;
+}
+
+void ThreadPool::collect(std::vector<Job> &done)
+{
+	// Reset the counter first: a job finishing after this bumps it again
+	uint64_t count;
+	while (read(_eventFd, &count, sizeof(count)) > 0)
+		;
+
+	pthread_mutex_lock(&_mutex);
+	done.insert(done.end(), _done.begin(), _done.end());
+	_done.clear();
+	pthread_mutex_unlock(&_mutex);
+}
+
+void *ThreadPool::workerMain(void *arg)
+{
+	static_cast<ThreadPool *>(arg)->work();
+	return NULL;
+}
+
+void ThreadPool::work()
+{
+	pthread_mutex_lock(&_mutex);
+	while (true)
+	{
+		while (_queue.empty() && !_stopping)
+			pthread_cond_wait(&_cond, &_mutex);
+		if (_stopping)
+			break;
+
+		Job job = _queue.front();
+		_queue.pop_front();
+		pthread_mutex_unlock(&_mutex);
+
+		job.task->run();
+
+		pthread_mutex_lock(&_mutex);
+		_done.push_back(job);
+		uint64_t one = 1;
+		ssize_t written = write(_eventFd, &one, sizeof(one)); // Only fails when the counter is already huge
+		(void)written;
+	}
+	pthread_mutex_unlock(&_mutex);
+}
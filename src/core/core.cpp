@@ -180,9 +180,38 @@ bool WebServer::setupServers()
 			Logger::info("Server configured: " + host + ":" + toString(port));
 	}
 
+	configureCaches();
 	return true;
 }
 
+void WebServer::configureCaches()
+{
+	// Both caches are process-wide and shared by all servers:
+	// the first server block that enables one provides its settings
+	bool openFileCacheSet = false;
+	bool staticCacheSet = false;
+	for (size_t i = 0; i < _serverConfigs.size(); i++)
+	{
+		const ServerConfig &config = _serverConfigs[i];
+		const OpenFileCacheConfig &cache = config.getOpenFileCache();
+		if (!openFileCacheSet && cache.maxEntries > 0)
+		{
+			OpenFileCache::getInstance()->configure(cache.maxEntries, cache.inactive, cache.valid, cache.errors);
+			Logger::info("Open file cache: max=" + toString(cache.maxEntries) + " inactive=" + toString(cache.inactive) +
+						 "s valid=" + toString(cache.valid) + "s errors=" + (cache.errors ? "on" : "off"));
+			openFileCacheSet = true;
+		}
+
+		if (!staticCacheSet && config.getStaticCacheSize() > 0)
+		{
+			if (_eventLoop->enableResponseCache(config.getStaticCacheSize(), config.getStaticCacheMaxFile()))
+				Logger::info("Static response cache: " + toString(config.getStaticCacheSize()) + " bytes, files up to " +
+							 toString(config.getStaticCacheMaxFile()) + " bytes");
+			staticCacheSet = true;
+		}
+	}
+}
+
 void WebServer::cleanup()
 {
 	Logger::debug("Cleaning up WebServer resources");
@@ -196,5 +225,7 @@ void WebServer::cleanup()
 
 	// ServerSockets are owned and deleted by EventLoop
 
+	OpenFileCache::getInstance()->clear();
+
 	_initialized = false;
 }
@@ -1,33 +1,80 @@
 #include "http/HttpParser.hpp"
 
 HttpParser::HttpParser()
-	: _currentState(new ParseRequestLineState()),
+	: _currentState(NULL),
+	  _pos(0),
+	  _scanPos(0),
 	  _maxBodySize(MAX_BODY_SIZE), // Default from defines.hpp
+	  _maxRequestLine(MAX_REQUEST_LINE),
+	  _maxHeaderLine(MAX_HEADER_LINE),
+	  _maxHeaderCount(MAX_HEADER_COUNT),
+	  _maxHeaderSize(MAX_HEADER_SIZE),
+	  _headersComplete(false),
+	  _chunked(false),
+	  _contentLength(0),
 	  _isComplete(false),
 	  _hasError(false),
 	  _errorMessage("")
 {
+	_currentState = &_requestLineState;
+	_request.bindBuffer(&_buffer);
 	Logger::debug("HttpParser created");
 }
 
 HttpParser::~HttpParser()
 {
-	delete _currentState;
 	Logger::debug("HttpParser destroyed");
 }
 
 void HttpParser::parse(const std::string &data)
+{
+	parse(data.data(), data.size());
+}
+
+void HttpParser::parse(const char *data, size_t length)
 {
 	if (_isComplete || _hasError)
 		return; // Already finished parsing
 
 	// Append new data to buffer
-	_buffer += data;
+	_buffer.append(data, length);
+
+	// Body bytes that arrive before resume() just wait in the buffer
+	if (_headersComplete)
+		return;
 
 	// Let current state handle the parsing
 	_currentState->parse(*this);
 }
 
+bool HttpParser::headersComplete() const
+{
+	return _headersComplete;
+}
+
+void HttpParser::resume()
+{
+	if (!_headersComplete)
+		return;
+	_headersComplete = false;
+	_headersState.startBody(*this);
+}
+
+bool HttpParser::expectsBody() const
+{
+	return _chunked || _contentLength > 0;
+}
+
+bool HttpParser::isChunked() const
+{
+	return _chunked;
+}
+
+size_t HttpParser::getContentLength() const
+{
+	return _contentLength;
+}
+
 bool HttpParser::isComplete() const
 {
 	return _isComplete;
@@ -57,21 +104,47 @@ void HttpParser::reset()
 {
 	Logger::debug("Resetting HttpParser");
 
+	_buffer.clear(); // capacity is kept, so keep-alive requests reuse the allocation
+	resetState();
+}
+
+void HttpParser::startNextRequest()
+{
+	// Bytes after the finished request belong to the next (pipelined) one
+	_buffer.erase(0, _isComplete ? _pos : _buffer.size());
+	resetState();
+	if (!_buffer.empty())
+		_currentState->parse(*this);
+}
+
+void HttpParser::resetState()
+{
 	_request.clear();
-	_buffer.clear();
+	_pos = 0;
+	_scanPos = 0;
+	_headersComplete = false;
+	_chunked = false;
+	_contentLength = 0;
 	_isComplete = false;
 	_hasError = false;
 	_errorMessage.clear();
 
 	// Reset to initial state
-	delete _currentState;
-	_currentState = new ParseRequestLineState();
+	_currentState = &_requestLineState;
+}
+
+void HttpParser::setHeaderLimits(size_t maxRequestLine, size_t maxHeaderLine, size_t maxHeaderCount, size_t maxHeaderSize)
+{
+	_maxRequestLine = maxRequestLine;
+	_maxHeaderLine = maxHeaderLine;
+	_maxHeaderCount = maxHeaderCount;
+	_maxHeaderSize = maxHeaderSize;
 }
 
 void HttpParser::setState(IParseState *newState)
 {
-	Logger::debug("State transition: " + _currentState->getName() + " -> " + newState->getName());
-	delete _currentState;
+	if (Logger::isEnabled(Logger::LEVEL_DEBUG))
+		Logger::debug(std::string("State transition: ") + _currentState->getName() + " -> " + newState->getName());
 	_currentState = newState;
 }
 
@@ -79,8 +152,6 @@ void HttpParser::setComplete()
 {
 	_isComplete = true;
 	Logger::info("HTTP request parsing complete");
-	// Parse cookies now that headers are fully available
-	_request.parseCookies();
 }
 
 void HttpParser::setError(const std::string &message)
@@ -89,3 +160,63 @@ void HttpParser::setError(const std::string &message)
 	_errorMessage = message;
 	Logger::error("HTTP parsing error: " + message);
 }
+
+HttpParser::LineStatus HttpParser::nextLine(HttpSlice &line, size_t maxLength)
+{
+	// One SIMD pass finds the line end and validates the bytes before it:
+	// the first CTL/DEL byte must be the '\r' of a CRLF, anything else is malformed
+	size_t start = (_scanPos > _pos) ? _scanPos : _pos;
+	const char *base = _buffer.data();
+	size_t length = _buffer.size() - start;
+	size_t idx = HttpScanner::findLineEnd(base + start, length);
+	if (idx == length)
+	{
+		// A partial line already over the limit will never become valid:
+		// fail now instead of buffering until the client stops sending
+		if (_buffer.size() - _pos > maxLength)
+			return LINE_TOO_LONG;
+		_scanPos = _buffer.size(); // Everything so far is clean, don't rescan it
+		return LINE_INCOMPLETE;
+	}
+
+	size_t at = start + idx;
+	if (at - _pos > maxLength)
+		return LINE_TOO_LONG;
+	if (base[at] != '\r')
+		return LINE_INVALID;
+	if (at + 1 >= _buffer.size())
+	{
+		_scanPos = at; // '\r' is the last byte, wait for its '\n'
+		return LINE_INCOMPLETE;
+	}
+	if (base[at + 1] != '\n')
+		return LINE_INVALID;
+
+	line = HttpSlice(_pos, at - _pos);
+	_pos = at + 2;
+	_scanPos = _pos;
+	return LINE_OK;
+}
+
+size_t HttpParser::available() const
+{
+	return _buffer.size() - _pos;
+}
+
+const char *HttpParser::cursor() const
+{
+	return _buffer.data() + _pos;
+}
+
+void HttpParser::consumeBody(size_t length)
+{
+	_buffer.erase(_pos, length);
+	_scanPos = _pos;
+}
+
+void HttpParser::discardFrom(size_t offset)
+{
+	_buffer.erase(offset, _pos - offset);
+	_pos = offset;
+	_scanPos = _pos;
+}
@@ -1,8 +1,54 @@
 #include "http/HttpRequest.hpp"
+#include "utils/utils.hpp"
+#include <cstring>
+
+namespace
+{
+	// Canonical spelling of each HttpHeaderId, indexed by id
+	const char *const kHeaderNames[HDR_COUNT] = {
+		"Host",
+		"Content-Length",
+		"Transfer-Encoding",
+		"Connection",
+		"Cookie",
+		"Content-Type",
+		"Expect",
+		"If-None-Match",
+		"Range",
+		"Accept-Encoding",
+		"If-Range",
+		"If-Modified-Since"};
+
+	// True if the path has a ".." segment ("/..", "/../", "..")
+	bool hasDotDotSegment(const char *p, size_t length)
+	{
+		size_t segStart = 0;
+		for (size_t i = 0; i <= length; i++)
+		{
+			if (i == length || p[i] == '/')
+			{
+				if (i - segStart == 2 && p[segStart] == '.' && p[segStart + 1] == '.')
+					return true;
+				segStart = i + 1;
+			}
+		}
+		return false;
+	}
+
+	inline HttpHeaderId matchHeader(const StringView &name, HttpHeaderId id)
+	{
+		return name.iequals(kHeaderNames[id]) ? id : HDR_OTHER;
+	}
+}
 
 HttpRequest::HttpRequest()
-	: method(HTTP_UNKNOWN), uri(""), version("HTTP/1.1"), body("")
+	: raw(NULL), method(HTTP_UNKNOWN), body(""), pathDecoded(false), queryParsed(false), cookiesParsed(false)
 {
+	// Typical browser requests carry 8-15 headers; reserving once per
+	// connection means keep-alive requests never grow the table again
+	headers.reserve(16);
+	for (int i = 0; i < HDR_COUNT; ++i)
+		knownHeaders[i] = -1;
 }
 
 HttpRequest::~HttpRequest()
@@ -15,34 +61,63 @@ HttpRequest &HttpRequest::setMethod(HttpMethod m)
 	return *this;
 }
 
-HttpRequest &HttpRequest::setUri(const std::string &u)
+void HttpRequest::bindBuffer(const std::string *buffer)
+{
+	raw = buffer;
+}
+
+HttpRequest &HttpRequest::setUri(const HttpSlice &u)
 {
 	uri = u;
 	return *this;
 }
 
-HttpRequest &HttpRequest::setVersion(const std::string &v)
+HttpRequest &HttpRequest::setVersion(const HttpSlice &v)
 {
 	version = v;
 	return *this;
 }
 
-HttpRequest &HttpRequest::addHeader(const std::string &key, const std::string &value)
+HttpRequest &HttpRequest::addHeader(const HttpSlice &key, const HttpSlice &value)
 {
-	headers[key] = value;
+	StringView name = view(key);
+	HttpHeaderId id = lookupHeaderId(name.data(), name.size());
+
+	// Later duplicates override earlier ones, same as the old map semantics
+	int existing = (id != HDR_OTHER) ? knownHeaders[id] : findHeader(name);
+	if (existing >= 0)
+	{
+		headers[existing].value = value;
+		return *this;
+	}
+
+	HttpHeaderField field;
+	field.name = key;
+	field.value = value;
+	field.id = id;
+	if (id != HDR_OTHER)
+		knownHeaders[id] = static_cast<int>(headers.size());
+	headers.push_back(field);
 	return *this;
 }
 
-HttpRequest &HttpRequest::setBody(const std::string &b)
+HttpRequest &HttpRequest::appendBody(const char *data, size_t length)
 {
-	body = b;
+	body.append(data, length);
 	return *this;
 }
 
-void HttpRequest::parseCookies()
+HttpRequest &HttpRequest::swapBody(std::string &other)
 {
+	body.swap(other);
+	return *this;
+}
+
+void HttpRequest::parseCookies() const
+{
+	cookiesParsed = true;
 	cookies.clear();
-	std::string cookieHeader = getHeader("Cookie");
+	StringView cookieHeader = getHeader(HDR_COOKIE);
 	if (cookieHeader.empty())
 		return;
 
@@ -50,15 +125,15 @@ void HttpRequest::parseCookies()
 	while (pos < cookieHeader.length())
 	{
 		size_t end = cookieHeader.find(';', pos);
-		if (end == std::string::npos)
+		if (end == StringView::npos)
 			end = cookieHeader.length();
 
-		std::string pair = cookieHeader.substr(pos, end - pos);
+		StringView pair = cookieHeader.substr(pos, end - pos);
 		size_t eq = pair.find('=');
-		if (eq != std::string::npos)
+		if (eq != StringView::npos)
 		{
-			std::string key = pair.substr(0, eq);
-			std::string val = pair.substr(eq + 1);
+			std::string key = pair.substr(0, eq).str();
+			std::string val = pair.substr(eq + 1).str();
 
 			// Trim whitespace
 			size_t first = key.find_first_not_of(" ");
@@ -72,12 +147,17 @@ void HttpRequest::parseCookies()
 	}
 }
 
-std::string HttpRequest::getCookie(const std::string &key) const
+const std::string &HttpRequest::getCookie(const std::string &key) const
 {
+	static const std::string empty;
+
+	if (!cookiesParsed)
+		parseCookies();
+
 	std::map<std::string, std::string>::const_iterator it = cookies.find(key);
 	if (it != cookies.end())
 		return it->second;
-	return "";
+	return empty;
 }
 
 HttpMethod HttpRequest::getMethod() const
@@ -85,7 +165,7 @@ HttpMethod HttpRequest::getMethod() const
 	return method;
 }
 
-std::string HttpRequest::getMethodString() const
+const char *HttpRequest::getMethodString() const
 {
 	switch (method)
 	{
@@ -104,34 +184,277 @@ std::string HttpRequest::getMethodString() const
 	}
 }
 
-std::string HttpRequest::getUri() const
+StringView HttpRequest::getUri() const
 {
-	return uri;
+	return view(uri);
 }
 
-std::string HttpRequest::getHeader(const std::string &key) const
+StringView HttpRequest::getPath() const
 {
-	std::map<std::string, std::string>::const_iterator it = headers.find(key);
-	if (it != headers.end())
-		return it->second;
-	return "";
+	if (pathDecoded)
+		return StringView(decodedPath);
+	return view(path);
 }
 
-const std::map<std::string, std::string> &HttpRequest::getHeaders() const
+StringView HttpRequest::getQuery() const
 {
-	return headers;
+	return view(query);
+}
+
+bool HttpRequest::parseTarget()
+{
+	// "/path?query#fragment": one pass, the pieces are slices of the uri slice
+	StringView u = view(uri);
+	size_t end = u.find('#');
+	if (end == StringView::npos)
+		end = u.size();
+
+	size_t qmark = u.substr(0, end).find('?');
+	if (qmark == StringView::npos)
+	{
+		path = HttpSlice(uri.offset, end);
+		query = HttpSlice(uri.offset + end, 0);
+	}
+	else
+	{
+		path = HttpSlice(uri.offset, qmark);
+		query = HttpSlice(uri.offset + qmark + 1, end - qmark - 1);
+	}
+
+	// Most paths have no escapes and stay a plain slice of the receive buffer.
+	// Otherwise decode in place inside decodedPath (the raw uri stays intact for logs/CGI).
+	StringView rawPath = view(path);
+	pathDecoded = rawPath.find('%') != StringView::npos;
+	const char *p = rawPath.data();
+	size_t length = rawPath.size();
+	if (pathDecoded)
+	{
+		decodedPath.assign(rawPath.data(), rawPath.size());
+		if (!percentDecode(decodedPath.data(), decodedPath.size(), &decodedPath[0], length, false))
+			return false;
+		decodedPath.resize(length);
+		p = decodedPath.data();
+
+		// "%00" would truncate the path once it reaches a C string API
+		if (std::memchr(p, '\0', length))
+			return false;
+	}
+
+	// Checked after decoding so "%2e%2e" can't slip past as a traversal
+	return !hasDotDotSegment(p, length);
+}
+
+void HttpRequest::parseQuery() const
+{
+	queryParsed = true;
+	queryParams.clear();
+
+	// Copy the query once, then decode every name and value in place:
+	// decoded bytes are packed to the front while reading further on
+	StringView q = view(query);
+	queryScratch.assign(q.data(), q.size());
+	char *buf = queryScratch.empty() ? NULL : &queryScratch[0];
+	size_t w = 0;
+	size_t r = 0;
+	while (r < queryScratch.size())
+	{
+		size_t amp = r;
+		while (amp < queryScratch.size() && buf[amp] != '&')
+			amp++;
+		size_t eq = r;
+		while (eq < amp && buf[eq] != '=')
+			eq++;
+
+		if (amp > r)
+		{
+			HttpQueryParam param;
+			size_t n = 0;
+			if (!percentDecode(buf + r, eq - r, buf + w, n, true))
+			{
+				std::memmove(buf + w, buf + r, eq - r); // Malformed escapes are kept as sent
+				n = eq - r;
+			}
+			param.name = HttpSlice(w, n);
+			w += n;
+
+			size_t valStart = (eq < amp) ? eq + 1 : amp;
+			if (!percentDecode(buf + valStart, amp - valStart, buf + w, n, true))
+			{
+				std::memmove(buf + w, buf + valStart, amp - valStart);
+				n = amp - valStart;
+			}
+			param.value = HttpSlice(w, n);
+			w += n;
+			queryParams.push_back(param);
+		}
+		r = amp + 1;
+	}
+}
+
+StringView HttpRequest::getQueryParam(const StringView &name) const
+{
+	if (!queryParsed)
+		parseQuery();
+	for (size_t i = 0; i < queryParams.size(); ++i)
+	{
+		if (getQueryParamName(i) == name)
+			return getQueryParamValue(i);
+	}
+	return StringView();
 }
 
-std::string HttpRequest::getBody() const
+size_t HttpRequest::getQueryParamCount() const
+{
+	if (!queryParsed)
+		parseQuery();
+	return queryParams.size();
+}
+
+StringView HttpRequest::getQueryParamName(size_t index) const
+{
+	if (!queryParsed)
+		parseQuery();
+	const HttpSlice &s = queryParams[index].name;
+	return StringView(queryScratch.data() + s.offset, s.length);
+}
+
+StringView HttpRequest::getQueryParamValue(size_t index) const
+{
+	if (!queryParsed)
+		parseQuery();
+	const HttpSlice &s = queryParams[index].value;
+	return StringView(queryScratch.data() + s.offset, s.length);
+}
+
+StringView HttpRequest::getVersion() const
+{
+	if (version.length == 0)
+		return StringView("HTTP/1.1", 8);
+	return view(version);
+}
+
+StringView HttpRequest::getHeader(HttpHeaderId id) const
+{
+	if (id >= HDR_COUNT || knownHeaders[id] < 0)
+		return StringView();
+	return view(headers[knownHeaders[id]].value);
+}
+
+StringView HttpRequest::getHeader(const StringView &name) const
+{
+	HttpHeaderId id = lookupHeaderId(name.data(), name.size());
+	if (id != HDR_OTHER)
+		return getHeader(id);
+
+	int i = findHeader(name);
+	if (i < 0)
+		return StringView();
+	return view(headers[i].value);
+}
+
+bool HttpRequest::hasHeader(HttpHeaderId id) const
+{
+	return id < HDR_COUNT && knownHeaders[id] >= 0;
+}
+
+size_t HttpRequest::getHeaderCount() const
+{
+	return headers.size();
+}
+
+StringView HttpRequest::getHeaderName(size_t index) const
+{
+	return view(headers[index].name);
+}
+
+StringView HttpRequest::getHeaderValue(size_t index) const
+{
+	return view(headers[index].value);
+}
+
+HttpHeaderId HttpRequest::getHeaderId(size_t index) const
+{
+	return headers[index].id;
+}
+
+HttpHeaderId HttpRequest::lookupHeaderId(const char *name, size_t length)
+{
+	// Length picks at most two candidates, so an unknown header costs
+	// one switch and usually no compare at all
+	StringView n(name, length);
+	switch (length)
+	{
+	case 4:
+		return matchHeader(n, HDR_HOST);
+	case 5:
+		return matchHeader(n, HDR_RANGE);
+	case 6:
+		if (matchHeader(n, HDR_COOKIE) != HDR_OTHER)
+			return HDR_COOKIE;
+		return matchHeader(n, HDR_EXPECT);
+	case 8:
+		return matchHeader(n, HDR_IF_RANGE);
+	case 10:
+		return matchHeader(n, HDR_CONNECTION);
+	case 12:
+		return matchHeader(n, HDR_CONTENT_TYPE);
+	case 13:
+		return matchHeader(n, HDR_IF_NONE_MATCH);
+	case 14:
+		return matchHeader(n, HDR_CONTENT_LENGTH);
+	case 15:
+		return matchHeader(n, HDR_ACCEPT_ENCODING);
+	case 17:
+		if (matchHeader(n, HDR_TRANSFER_ENCODING) != HDR_OTHER)
+			return HDR_TRANSFER_ENCODING;
+		return matchHeader(n, HDR_IF_MODIFIED_SINCE);
+	default:
+		return HDR_OTHER;
+	}
+}
+
+StringView HttpRequest::view(const HttpSlice &slice) const
+{
+	if (!raw)
+		return StringView();
+	return StringView(raw->data() + slice.offset, slice.length);
+}
+
+int HttpRequest::findHeader(const StringView &name) const
+{
+	for (size_t i = 0; i < headers.size(); ++i)
+	{
+		if (view(headers[i].name).iequals(name))
+			return static_cast<int>(i);
+	}
+	return -1;
+}
+
+const std::string &HttpRequest::getBody() const
 {
 	return body;
 }
 
+size_t HttpRequest::getBodySize() const
+{
+	return body.size();
+}
+
 void HttpRequest::clear()
 {
 	method = HTTP_UNKNOWN;
-	uri.clear();
-	version = "HTTP/1.1";
-	headers.clear();
+	uri = HttpSlice();
+	version = HttpSlice();
+	headers.clear(); // keeps capacity for the next request on this connection
+	for (int i = 0; i < HDR_COUNT; ++i)
+		knownHeaders[i] = -1;
 	body.clear();
+	path = HttpSlice();
+	query = HttpSlice();
+	pathDecoded = false;
+	decodedPath.clear(); // capacity kept
+	queryParsed = false;
+	queryParams.clear();
+	cookiesParsed = false;
+	cookies.clear();
 }
@@ -1,8 +1,65 @@
 #include "http/HttpResponse.hpp"
+#include "utils/utils.hpp"
+
+namespace
+{
+    // The Server line of dateServerHeaders(), also sent alone after a Date the response set itself
+    const char kServerHeader[] = "Server: " SERVER_SOFTWARE "\r\n";
+
+    // Status lines, rendered at compile time; a response whose reason is the standard one
+    // copies its status line instead of formatting it
+    struct StatusLine
+    {
+        int code;
+        const char *reason;
+        const char *line;
+    };
+
+    const StatusLine kStatusLines[] = {
+        {100, "Continue", "HTTP/1.1 100 Continue\r\n"},
+        {200, "OK", "HTTP/1.1 200 OK\r\n"},
+        {201, "Created", "HTTP/1.1 201 Created\r\n"},
+        {204, "No Content", "HTTP/1.1 204 No Content\r\n"},
+        {206, "Partial Content", "HTTP/1.1 206 Partial Content\r\n"},
+        {301, "Moved Permanently", "HTTP/1.1 301 Moved Permanently\r\n"},
+        {302, "Found", "HTTP/1.1 302 Found\r\n"},
+        {303, "See Other", "HTTP/1.1 303 See Other\r\n"},
+        {304, "Not Modified", "HTTP/1.1 304 Not Modified\r\n"},
+        {307, "Temporary Redirect", "HTTP/1.1 307 Temporary Redirect\r\n"},
+        {308, "Permanent Redirect", "HTTP/1.1 308 Permanent Redirect\r\n"},
+        {400, "Bad Request", "HTTP/1.1 400 Bad Request\r\n"},
+        {403, "Forbidden", "HTTP/1.1 403 Forbidden\r\n"},
+        {404, "Not Found", "HTTP/1.1 404 Not Found\r\n"},
+        {405, "Method Not Allowed", "HTTP/1.1 405 Method Not Allowed\r\n"},
+        {408, "Request Timeout", "HTTP/1.1 408 Request Timeout\r\n"},
+        {411, "Length Required", "HTTP/1.1 411 Length Required\r\n"},
+        {413, "Payload Too Large", "HTTP/1.1 413 Payload Too Large\r\n"},
+        {414, "URI Too Long", "HTTP/1.1 414 URI Too Long\r\n"},
+        {416, "Range Not Satisfiable", "HTTP/1.1 416 Range Not Satisfiable\r\n"},
+        {417, "Expectation Failed", "HTTP/1.1 417 Expectation Failed\r\n"},
+        {431, "Request Header Fields Too Large", "HTTP/1.1 431 Request Header Fields Too Large\r\n"},
+        {500, "Internal Server Error", "HTTP/1.1 500 Internal Server Error\r\n"},
+        {501, "Not Implemented", "HTTP/1.1 501 Not Implemented\r\n"},
+        {502, "Bad Gateway", "HTTP/1.1 502 Bad Gateway\r\n"},
+        {504, "Gateway Timeout", "HTTP/1.1 504 Gateway Timeout\r\n"},
+        {505, "HTTP Version Not Supported", "HTTP/1.1 505 HTTP Version Not Supported\r\n"},
+        {508, "Loop Detected", "HTTP/1.1 508 Loop Detected\r\n"}};
+
+    const char *findStatusLine(int code, const std::string &reason)
+    {
+        for (size_t i = 0; i < sizeof(kStatusLines) / sizeof(kStatusLines[0]); i++)
+        {
+            if (kStatusLines[i].code == code)
+                return reason == kStatusLines[i].reason ? kStatusLines[i].line : NULL;
+        }
+        return NULL;
+    }
+}
 
 HttpResponse::HttpResponse()
-    : statusCode(HTTP_OK), version("HTTP/1.1"), reasonPhrase("OK"), body(""),
-      _isCgi(false), _cgiScriptPath(""), _cgiInterpreterPath("") {}
+    : statusCode(HTTP_OK), version("HTTP/1.1"), reasonPhrase("OK"), _statusLine(kStatusLines[1].line), body(""),
+      _fileFd(-1), _fileOffset(0), _fileLength(0),
+      _pending(NULL) {}
 
 HttpResponse::~HttpResponse() {}
 
@@ -10,21 +67,123 @@ HttpResponse &HttpResponse::setStatus(int code, const std::string &reason)
 {
     statusCode = code;
     reasonPhrase = reason;
+    _statusLine = findStatusLine(code, reason);
     return *this;
 }
 
 HttpResponse &HttpResponse::addHeader(const std::string &key, const std::string &value)
 {
-    headers[key] = value;
+    for (size_t i = 0; i < headers.size(); i++)
+    {
+        if (headers[i].first == key)
+        {
+            headers[i].second = value;
+            return *this;
+        }
+    }
+    headers.push_back(Header(key, value));
+    return *this;
+}
+
+HttpResponse &HttpResponse::removeHeader(const std::string &key)
+{
+    for (size_t i = 0; i < headers.size(); i++)
+    {
+        if (headers[i].first == key)
+        {
+            headers.erase(headers.begin() + i);
+            break;
+        }
+    }
+    return *this;
+}
+
+HttpResponse &HttpResponse::addHeaderFragment(const std::string &fragment)
+{
+    _headerFragment += fragment;
+    return *this;
+}
+
+HttpResponse &HttpResponse::addVary(const std::string &header)
+{
+    std::string vary = getHeader("Vary");
+    if (vary.empty())
+        return addHeader("Vary", header);
+    if (vary.find(header) == std::string::npos)
+        addHeader("Vary", vary + ", " + header);
     return *this;
 }
 
+HttpResponse &HttpResponse::setContentEncoding(const std::string &coding)
+{
+    addHeader("Content-Encoding", coding);
+    return addVary("Accept-Encoding");
+}
+
+HttpResponse &HttpResponse::setChunked()
+{
+    removeHeader("Content-Length");
+    return addHeader("Transfer-Encoding", "chunked");
+}
+
 HttpResponse &HttpResponse::setBody(const std::string &bodyContent)
 {
+    _fileFd = -1; // An in-memory body replaces a file segment (whose fd the caller owns)
+    _fileOffset = 0;
+    _fileLength = 0;
+    _filePrefix.clear();
+    _fileSegments.clear();
+    _fileTrailer.clear();
     body = bodyContent;
     return *this;
 }
 
+HttpResponse &HttpResponse::setFileBody(int fd, off_t offset, size_t length, const std::string &path)
+{
+    body.clear();
+    _fileFd = fd;
+    _fileOffset = offset;
+    _fileLength = length;
+    _filePath = path;
+    _filePrefix.clear();
+    _fileSegments.clear();
+    _fileTrailer.clear();
+    return *this;
+}
+
+HttpResponse &HttpResponse::setFilePrefix(const std::string &prefix)
+{
+    _filePrefix = prefix;
+    return *this;
+}
+
+HttpResponse &HttpResponse::addFileSegment(const std::string &before, off_t offset, size_t length)
+{
+    _fileSegments.push_back(FileSegment(before, offset, length));
+    return *this;
+}
+
+HttpResponse &HttpResponse::setFileTrailer(const std::string &trailer)
+{
+    _fileTrailer = trailer;
+    return *this;
+}
+
+HttpResponse &HttpResponse::setFilePath(const std::string &path)
+{
+    _filePath = path;
+    return *this;
+}
+
+bool HttpResponse::hasFileBody() const { return _fileFd != -1; }
+int HttpResponse::getFileFd() const { return _fileFd; }
+off_t HttpResponse::getFileOffset() const { return _fileOffset; }
+size_t HttpResponse::getFileLength() const { return _fileLength; }
+const std::string &HttpResponse::getFilePath() const { return _filePath; }
+const std::string &HttpResponse::getFilePrefix() const { return _filePrefix; }
+const std::vector<FileSegment> &HttpResponse::getFileSegments() const { return _fileSegments; }
+const std::string &HttpResponse::getFileTrailer() const { return _fileTrailer; }
+
 HttpResponse &HttpResponse::addCookie(const std::string &key, const std::string &value, int maxAge)
 {
     std::stringstream ss;
@@ -37,9 +196,11 @@ HttpResponse &HttpResponse::addCookie(const std::string &key, const std::string
 
 std::string HttpResponse::getHeader(const std::string &key) const
 {
-    std::map<std::string, std::string>::const_iterator it = headers.find(key);
-    if (it != headers.end())
-        return it->second;
+    for (size_t i = 0; i < headers.size(); i++)
+    {
+        if (headers[i].first == key)
+            return headers[i].second;
+    }
     return "";
 }
 
@@ -48,36 +209,118 @@ int HttpResponse::getStatusCode() const
     return statusCode;
 }
 
-void HttpResponse::setCgi(bool isCgi) { _isCgi = isCgi; }
-bool HttpResponse::isCgi() const { return _isCgi; }
-void HttpResponse::setCgiInfo(const std::string &script, const std::string &interpreter)
+const std::string &HttpResponse::getBody() const
 {
-    _cgiScriptPath = script;
-    _cgiInterpreterPath = interpreter;
+    return body;
 }
-std::string HttpResponse::getCgiScriptPath() const { return _cgiScriptPath; }
-std::string HttpResponse::getCgiInterpreterPath() const { return _cgiInterpreterPath; }
 
-std::string HttpResponse::build() const
+bool HttpResponse::isChunked() const
+{
+    return getHeader("Transfer-Encoding") == "chunked";
+}
+
+HttpResponse &HttpResponse::setPending(PendingResponse *pending)
+{
+    _pending = pending;
+    return *this;
+}
+
+PendingResponse *HttpResponse::getPending() const
+{
+    return _pending;
+}
+
+const char *HttpResponse::reasonPhraseFor(int code)
+{
+    for (size_t i = 0; i < sizeof(kStatusLines) / sizeof(kStatusLines[0]); i++)
+    {
+        if (kStatusLines[i].code == code)
+            return kStatusLines[i].reason;
+    }
+    return "Error";
+}
+
+const std::string &HttpResponse::dateServerHeaders()
 {
-    std::ostringstream response;
+    static time_t renderedAt = 0;
+    static std::string block;
+    time_t now = time(NULL);
+    if (now != renderedAt)
+    {
+        renderedAt = now;
+        block = "Date: " + formatHttpDate(now) + "\r\n" + kServerHeader;
+    }
+    return block;
+}
+
+void HttpResponse::appendHead(std::string &out, bool withDate) const
+{
+    // One reserve, then plain appends: the status line and fragments are copied, not formatted
+    size_t size = 64 + _headerFragment.size();
+    for (size_t i = 0; i < headers.size(); i++)
+        size += headers[i].first.size() + headers[i].second.size() + 4;
+    for (size_t i = 0; i < cookies.size(); i++)
+        size += cookies[i].size() + 14;
+    out.reserve(out.size() + size + (withDate ? 64 : 0));
 
     // Status line
-    response << version << " " << statusCode << " " << reasonPhrase << "\r\n";
+    if (_statusLine)
+        out += _statusLine;
+    else
+    {
+        out += version;
+        out += ' ';
+        out += toString(statusCode);
+        out += ' ';
+        out += reasonPhrase;
+        out += "\r\n";
+    }
+
+    // Origin servers with a clock must send Date (RFC 9110 6.6.1); a CGI script may set its own,
+    // and then only Server is added (unless it set that too)
+    if (withDate && getHeader("Date").empty())
+        out += dateServerHeaders();
+    else if (withDate && getHeader("Server").empty())
+        out += kServerHeader;
 
     // Headers
-    for (std::map<std::string, std::string>::const_iterator it = headers.begin(); it != headers.end(); it++)
-        response << it->first << ": " << it->second << "\r\n";
+    for (size_t i = 0; i < headers.size(); i++)
+    {
+        out += headers[i].first;
+        out += ": ";
+        out += headers[i].second;
+        out += "\r\n";
+    }
+    out += _headerFragment;
 
     // Add cookies
     for (size_t i = 0; i < cookies.size(); i++)
-        response << "Set-Cookie: " << cookies[i] << "\r\n";
+    {
+        out += "Set-Cookie: ";
+        out += cookies[i];
+        out += "\r\n";
+    }
 
     // Empty line between headers and body
-    response << "\r\n";
+    out += "\r\n";
+}
 
-    // Body
-    response << body;
+void HttpResponse::appendTo(std::string &out) const
+{
+    appendHead(out);
+    out += body;
+}
 
-    return response.str();
+std::string HttpResponse::buildHead(bool withDate) const
+{
+    std::string head;
+    appendHead(head, withDate);
+    return head;
+}
+
+std::string HttpResponse::build() const
+{
+    std::string response;
+    appendTo(response);
+    return response;
 }
@@ -0,0 +1,303 @@
+#include "http/HttpScanner.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HTTPSCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+// ============================================================================
+// Scalar kernels (portable fallback, also used for SIMD tails)
+// ============================================================================
+
+namespace
+{
+	inline bool isLineBreaker(unsigned char c)
+	{
+		return (c < 0x20 && c != '\t') || c == 0x7f;
+	}
+
+	size_t findLineEndScalar(const char *data, size_t length)
+	{
+		for (size_t i = 0; i < length; i++)
+		{
+			if (isLineBreaker(static_cast<unsigned char>(data[i])))
+				return i;
+		}
+		return length;
+	}
+
+	size_t findCharScalar(const char *data, size_t length, char c)
+	{
+		for (size_t i = 0; i < length; i++)
+		{
+			if (data[i] == c)
+				return i;
+		}
+		return length;
+	}
+
+	// Given the position of a '\r', confirm it is followed by '\n'
+	inline bool isCRLFAt(const char *data, size_t length, size_t i)
+	{
+		return i + 1 < length && data[i + 1] == '\n';
+	}
+
+	size_t findCRLFScalar(const char *data, size_t length)
+	{
+		for (size_t i = 0; i + 1 < length; i++)
+		{
+			if (data[i] == '\r' && data[i + 1] == '\n')
+				return i;
+		}
+		return length;
+	}
+
+#ifdef HTTPSCANNER_X86
+
+	// ========================================================================
+	// SSE2 kernels (16 bytes per step; SSE2 is baseline on x86-64)
+	// ========================================================================
+
+	// Mask of bytes that are CTL-but-not-HTAB or DEL
+	// always_inline so the AVX2 kernels get a VEX-encoded copy (no SSE/AVX transition stalls)
+	__attribute__((target("sse2"), always_inline)) inline int lineBreakMask16(__m128i v)
+	{
+		// Unsigned "v <= 0x1f" is "min(v, 0x1f) == v"
+		__m128i ctl = _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1f)), v);
+		__m128i tab = _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'));
+		__m128i del = _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7f));
+		return _mm_movemask_epi8(_mm_or_si128(_mm_andnot_si128(tab, ctl), del));
+	}
+
+	__attribute__((target("sse2"))) size_t findLineEndSSE2(const char *data, size_t length)
+	{
+		size_t i = 0;
+		for (; i + 16 <= length; i += 16)
+		{
+			int mask = lineBreakMask16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)));
+			if (mask)
+				return i + __builtin_ctz(mask);
+		}
+		return i + findLineEndScalar(data + i, length - i);
+	}
+
+	__attribute__((target("sse2"))) size_t findCharSSE2(const char *data, size_t length, char c)
+	{
+		__m128i needle = _mm_set1_epi8(c);
+		size_t i = 0;
+		for (; i + 16 <= length; i += 16)
+		{
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+			int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+			if (mask)
+				return i + __builtin_ctz(mask);
+		}
+		return i + findCharScalar(data + i, length - i, c);
+	}
+
+	__attribute__((target("sse2"))) size_t findCRLFSSE2(const char *data, size_t length)
+	{
+		__m128i cr = _mm_set1_epi8('\r');
+		size_t i = 0;
+		for (; i + 16 <= length; i += 16)
+		{
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+			unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, cr)));
+			while (mask)
+			{
+				size_t pos = i + __builtin_ctz(mask);
+				if (isCRLFAt(data, length, pos))
+					return pos;
+				mask &= mask - 1;
+			}
+		}
+		if (i >= length)
+			return length;
+		size_t tail = findCRLFScalar(data + i, length - i);
+		return (tail == length - i) ? length : i + tail;
+	}
+
+	// ========================================================================
+	// AVX2 kernels (32 bytes per step, only used when the CPU reports AVX2)
+	// ========================================================================
+
+	__attribute__((target("avx2"))) size_t findLineEndAVX2(const char *data, size_t length)
+	{
+		const __m256i limit = _mm256_set1_epi8(0x1f);
+		const __m256i tab = _mm256_set1_epi8('\t');
+		const __m256i del = _mm256_set1_epi8(0x7f);
+		size_t i = 0;
+		for (; i + 32 <= length; i += 32)
+		{
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+			__m256i ctl = _mm256_cmpeq_epi8(_mm256_min_epu8(v, limit), v);
+			__m256i bad = _mm256_or_si256(_mm256_andnot_si256(_mm256_cmpeq_epi8(v, tab), ctl),
+										  _mm256_cmpeq_epi8(v, del));
+			unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(bad));
+			if (mask)
+				return i + __builtin_ctz(mask);
+		}
+		if (i + 16 <= length)
+		{
+			int mask = lineBreakMask16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)));
+			if (mask)
+				return i + __builtin_ctz(mask);
+			i += 16;
+		}
+		return i + findLineEndScalar(data + i, length - i);
+	}
+
+	__attribute__((target("avx2"))) size_t findCharAVX2(const char *data, size_t length, char c)
+	{
+		const __m256i needle = _mm256_set1_epi8(c);
+		size_t i = 0;
+		for (; i + 32 <= length; i += 32)
+		{
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+			unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle)));
+			if (mask)
+				return i + __builtin_ctz(mask);
+		}
+		if (i + 16 <= length)
+		{
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+			int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c)));
+			if (mask)
+				return i + __builtin_ctz(mask);
+			i += 16;
+		}
+		return i + findCharScalar(data + i, length - i, c);
+	}
+
+	__attribute__((target("avx2"))) size_t findCRLFAVX2(const char *data, size_t length)
+	{
+		const __m256i cr = _mm256_set1_epi8('\r');
+		size_t i = 0;
+		for (; i + 32 <= length; i += 32)
+		{
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+			unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, cr)));
+			while (mask)
+			{
+				size_t pos = i + __builtin_ctz(mask);
+				if (isCRLFAt(data, length, pos))
+					return pos;
+				mask &= mask - 1;
+			}
+		}
+		if (i >= length)
+			return length;
+		size_t tail = findCRLFScalar(data + i, length - i);
+		return (tail == length - i) ? length : i + tail;
+	}
+
+#endif
+
+	// ========================================================================
+	// Runtime dispatch
+	// ========================================================================
+
+	typedef size_t (*LineEndFn)(const char *, size_t);
+	typedef size_t (*CharFn)(const char *, size_t, char);
+	typedef size_t (*CRLFFn)(const char *, size_t);
+
+	struct Kernels
+	{
+		HttpScanner::Impl impl;
+		LineEndFn lineEnd;
+		CharFn findChar;
+		CRLFFn crlf;
+	};
+
+	Kernels kernelsFor(HttpScanner::Impl impl)
+	{
+		Kernels k;
+		k.impl = HttpScanner::IMPL_SCALAR;
+		k.lineEnd = findLineEndScalar;
+		k.findChar = findCharScalar;
+		k.crlf = findCRLFScalar;
+#ifdef HTTPSCANNER_X86
+		if (impl == HttpScanner::IMPL_AVX2)
+		{
+			k.impl = impl;
+			k.lineEnd = findLineEndAVX2;
+			k.findChar = findCharAVX2;
+			k.crlf = findCRLFAVX2;
+		}
+		else if (impl == HttpScanner::IMPL_SSE2)
+		{
+			k.impl = impl;
+			k.lineEnd = findLineEndSSE2;
+			k.findChar = findCharSSE2;
+			k.crlf = findCRLFSSE2;
+		}
+#else
+		(void)impl;
+#endif
+		return k;
+	}
+
+	HttpScanner::Impl detectBestImpl()
+	{
+#ifdef HTTPSCANNER_X86
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+			return HttpScanner::IMPL_AVX2;
+		if (__builtin_cpu_supports("sse2"))
+			return HttpScanner::IMPL_SSE2;
+#endif
+		return HttpScanner::IMPL_SCALAR;
+	}
+
+	const HttpScanner::Impl s_bestImpl = detectBestImpl();
+	Kernels s_kernels = kernelsFor(s_bestImpl);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+size_t HttpScanner::findLineEnd(const char *data, size_t length)
+{
+	return s_kernels.lineEnd(data, length);
+}
+
+size_t HttpScanner::findChar(const char *data, size_t length, char c)
+{
+	return s_kernels.findChar(data, length, c);
+}
+
+size_t HttpScanner::findCRLF(const char *data, size_t length)
+{
+	return s_kernels.crlf(data, length);
+}
+
+HttpScanner::Impl HttpScanner::getImpl()
+{
+	return s_kernels.impl;
+}
+
+HttpScanner::Impl HttpScanner::getBestImpl()
+{
+	return s_bestImpl;
+}
+
+void HttpScanner::forceImpl(Impl impl)
+{
+	if (impl > s_bestImpl)
+		impl = s_bestImpl;
+	s_kernels = kernelsFor(impl);
+}
+
+const char *HttpScanner::getImplName(Impl impl)
+{
+	switch (impl)
+	{
+	case IMPL_AVX2:
+		return "avx2";
+	case IMPL_SSE2:
+		return "sse2";
+	default:
+		return "scalar";
+	}
+}
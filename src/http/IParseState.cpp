@@ -1,4 +1,6 @@
 #include "http/IParseState.hpp"
+#include "http/HttpParser.hpp"
+#include <cstring>
 
 // ============================================================================
 // ParseRequestLineState - Parse "GET /path HTTP/1.1"
@@ -8,53 +10,100 @@
 // Its the Delimiter that tells us where one line ends and the next begins
 // which is "\r\n" (carriage return + line feed)
 
+// Lines are never copied out of the buffer: nextLine() hands back a slice
+// (offset + length) and the cursor simply moves past the CRLF.
+// nextLine() also rejects control characters, so each byte is scanned once.
+
+namespace
+{
+	bool isBlank(char c)
+	{
+		return c == ' ' || c == '\t';
+	}
+
+	// Read the next whitespace-delimited token of a line, like "iss >> word"
+	bool nextToken(const char *base, size_t &i, size_t end, HttpSlice &out)
+	{
+		while (i < end && isBlank(base[i]))
+			i++;
+		size_t start = i;
+		while (i < end && !isBlank(base[i]))
+			i++;
+		if (i == start)
+			return false;
+		out = HttpSlice(start, i - start);
+		return true;
+	}
+
+	bool sliceIs(const char *base, const HttpSlice &s, const char *lit, size_t len)
+	{
+		return s.length == len && std::memcmp(base + s.offset, lit, len) == 0;
+	}
+
+	std::string sliceStr(const char *base, const HttpSlice &s)
+	{
+		return std::string(base + s.offset, s.length);
+	}
+}
+
 void ParseRequestLineState::parse(HttpParser &parser)
 {
 	// we search for the first CRLF to get the request line
-	size_t pos = findCRLF(parser._buffer);
-	if (pos == std::string::npos)
+	HttpSlice line;
+	HttpParser::LineStatus status = parser.nextLine(line, parser._maxRequestLine);
+	if (status == HttpParser::LINE_INCOMPLETE)
 		return; // Need more data
-
-	// Extract request line
-	std::string line = parser._buffer.substr(0, pos);
-	parser._buffer.erase(0, pos + 2); // Remove line + \r\n
-
-	Logger::debug("Parsing request line: " + line);
+	if (status == HttpParser::LINE_TOO_LONG)
+	{
+		Logger::warn("Request line exceeds " + toString(parser._maxRequestLine) + " bytes");
+		parser.setState(&parser._errorState);
+		parser.setError("URI Too Long"); // Specific message for 414
+		return;
+	}
+	if (status == HttpParser::LINE_INVALID)
+	{
+		parser.setState(&parser._errorState);
+		parser.setError("Malformed line (control character or bare CR/LF)");
+		return;
+	}
 
 	if (!parseRequestLine(parser, line))
 	{
-		parser.setState(new ParseErrorState());
-		parser.setError("Invalid request line: " + line);
+		parser.setState(&parser._errorState);
+		parser.setError("Invalid request line: " + sliceStr(parser._buffer.data(), line));
 		return;
 	}
 
 	// Transition to headers state
-	parser.setState(new ParseHeadersState());
+	parser._headersState.begin();
+	parser.setState(&parser._headersState);
 
 	// Continue parsing if buffer has data
-	if (!parser._buffer.empty())
+	if (parser.available() > 0)
 		parser._currentState->parse(parser);
 }
 
-bool ParseRequestLineState::parseRequestLine(HttpParser &parser, const std::string &line)
+bool ParseRequestLineState::parseRequestLine(HttpParser &parser, const HttpSlice &line)
 {
 	// Format: METHOD URI VERSION
 	// Example: GET /index.html HTTP/1.1
 
-	std::istringstream iss(line);
-	std::string method, uri, version;
+	const char *base = parser._buffer.data();
+	size_t i = line.offset;
+	size_t end = line.offset + line.length;
+	HttpSlice method, uri, version;
 
 	// Extract components, we expect exactly 3 components
 	// example: line = "GET /index.html HTTP/1.1"
 	// method = "GET", uri = "/index.html", version = "HTTP/1.1"
-	if (!(iss >> method >> uri >> version))
+	if (!nextToken(base, i, end, method) || !nextToken(base, i, end, uri) || !nextToken(base, i, end, version))
 		return false;
 
 	// Set method
-	HttpMethod httpMethod = stringToHttpMethod(method);
+	HttpMethod httpMethod = stringToHttpMethod(base + method.offset, method.length);
 	if (httpMethod == HTTP_UNKNOWN)
 	{
-		Logger::warn("Unknown HTTP method: " + method);
+		Logger::warn("Unknown HTTP method: " + sliceStr(base, method));
 		return false;
 	}
 
@@ -62,11 +111,19 @@ bool ParseRequestLineState::parseRequestLine(HttpParser &parser, const std::stri
 	parser._request.setUri(uri);
 	parser._request.setVersion(version);
 
+	// Split path/query and percent-decode the path once, here, for every consumer
+	if (!parser._request.parseTarget())
+	{
+		Logger::warn("Invalid request target: " + sliceStr(base, uri));
+		return false;
+	}
+
 	// Validate HTTP version
-	if (version != "HTTP/1.1" && version != "HTTP/1.0")
-		Logger::warn("Unsupported HTTP version: " + version); // Continue anyway for compatibility
+	if (!sliceIs(base, version, "HTTP/1.1", 8) && !sliceIs(base, version, "HTTP/1.0", 8))
+		Logger::warn("Unsupported HTTP version: " + sliceStr(base, version)); // Continue anyway for compatibility
 
-	Logger::debug("Request: " + method + " " + uri + " " + version);
+	if (Logger::isEnabled(Logger::LEVEL_DEBUG))
+		Logger::debug("Request: " + sliceStr(base, method) + " " + sliceStr(base, uri) + " " + sliceStr(base, version));
 	return true;
 }
 
@@ -74,111 +131,189 @@ bool ParseRequestLineState::parseRequestLine(HttpParser &parser, const std::stri
 // ParseHeadersState - Parse "Key: Value" headers
 // ============================================================================
 
+ParseHeadersState::ParseHeadersState()
+	: _lineCount(0)
+{
+}
+
+void ParseHeadersState::begin()
+{
+	_lineCount = 0;
+}
+
+void ParseHeadersState::fail(HttpParser &parser, const std::string &message)
+{
+	Logger::warn(message);
+	parser.setState(&parser._errorState);
+	parser.setError("Request Header Fields Too Large"); // Specific message for 431
+}
+
 void ParseHeadersState::parse(HttpParser &parser)
 {
 	while (true)
 	{
-		size_t pos = findCRLF(parser._buffer);
-		if (pos == std::string::npos)
+		HttpSlice line;
+		HttpParser::LineStatus status = parser.nextLine(line, parser._maxHeaderLine);
+		if (status == HttpParser::LINE_INCOMPLETE)
+		{
+			// Nothing past the cursor can be body yet, so the whole buffer is request head
+			if (parser._buffer.size() > parser._maxHeaderSize)
+				fail(parser, "Request head exceeds " + toString(parser._maxHeaderSize) + " bytes");
 			return; // Need more data
-
-		std::string line = parser._buffer.substr(0, pos);
-		parser._buffer.erase(0, pos + 2); // Remove line + \r\n
+		}
+		if (status == HttpParser::LINE_TOO_LONG)
+		{
+			fail(parser, "Header line exceeds " + toString(parser._maxHeaderLine) + " bytes");
+			return;
+		}
+		if (parser._pos > parser._maxHeaderSize)
+		{
+			fail(parser, "Request head exceeds " + toString(parser._maxHeaderSize) + " bytes");
+			return;
+		}
+		if (status == HttpParser::LINE_INVALID)
+		{
+			parser.setState(&parser._errorState);
+			parser.setError("Malformed line (control character or bare CR/LF)");
+			return;
+		}
 
 		// Empty line = end of headers
 		// when we reach an empty line, it means headers are done
 		// and now for the body (if any)
-		if (line.empty())
+		if (line.length == 0)
 		{
 			Logger::debug("Headers parsing complete");
 
-			// Check Transfer-Encoding: chunked
-			std::string te = parser.getRequest().getHeader("Transfer-Encoding");
-			if (te.find("chunked") != std::string::npos)
-			{
-				Logger::debug("Transfer-Encoding: chunked detected");
-				parser.setState(new ParseChunkedBodyState());
-				if (!parser._buffer.empty())
-					parser._currentState->parse(parser);
-				return;
-			}
-
-			// Check if we need to parse body
-			size_t contentLength = getContentLength(parser);
-			if (contentLength > parser.getMaxBodySize())
-			{
-				Logger::warn("Request body too large: " + toString(contentLength));
-				parser.setState(new ParseErrorState());
-				parser.setError("Payload Too Large"); // Specific message for 413
-				return;
-			}
-
-			if (contentLength > 0)
-			{
-				Logger::debug("Content-Length detected, transitioning to body parsing");
-				parser.setState(new ParseBodyState(contentLength));
+			// Record the body framing, then stop: the caller routes the request
+			// (location limits, allowed methods, Expect) before any body byte is read
+			StringView te = parser._request.getHeader(HDR_TRANSFER_ENCODING);
+			parser._chunked = sliceContains(te.data(), te.size(), "chunked");
+			parser._contentLength = parser._chunked ? 0 : getContentLength(parser);
+			parser._headersComplete = true;
+			return;
+		}
 
-				// Continue parsing body if buffer has data
-				if (!parser._buffer.empty())
-					parser._currentState->parse(parser);
-			}
-			else
-			{
-				// No body, parsing complete
-				parser.setState(new ParseCompleteState());
-				parser.setComplete();
-			}
+		if (++_lineCount > parser._maxHeaderCount)
+		{
+			fail(parser, "More than " + toString(parser._maxHeaderCount) + " header lines");
 			return;
 		}
 
 		// Parse header line
 		if (!parseHeaderLine(parser, line))
 		{
-			parser.setState(new ParseErrorState());
-			parser.setError("Invalid header line: " + line);
+			parser.setState(&parser._errorState);
+			parser.setError("Invalid header line: " + sliceStr(parser._buffer.data(), line));
 			return;
 		}
 	}
 }
 
-bool ParseHeadersState::parseHeaderLine(HttpParser &parser, const std::string &line)
+void ParseHeadersState::startBody(HttpParser &parser)
+{
+	// Check Transfer-Encoding: chunked
+	if (parser._chunked)
+	{
+		Logger::debug("Transfer-Encoding: chunked detected");
+		parser._chunkedBodyState.begin();
+		parser.setState(&parser._chunkedBodyState);
+		if (parser.available() > 0)
+			parser._currentState->parse(parser);
+		return;
+	}
+
+	// Check if we need to parse body
+	size_t contentLength = parser._contentLength;
+	if (contentLength > parser.getMaxBodySize())
+	{
+		Logger::warn("Request body too large: " + toString(contentLength));
+		parser.setState(&parser._errorState);
+		parser.setError("Payload Too Large"); // Specific message for 413
+		return;
+	}
+
+	if (contentLength > 0)
+	{
+		Logger::debug("Content-Length detected, transitioning to body parsing");
+		parser._bodyState.begin(contentLength);
+		parser.setState(&parser._bodyState);
+
+		// Continue parsing body if buffer has data
+		if (parser.available() > 0)
+			parser._currentState->parse(parser);
+	}
+	else
+	{
+		// No body, parsing complete
+		parser.setState(&parser._completeState);
+		parser.setComplete();
+	}
+}
+
+bool ParseHeadersState::parseHeaderLine(HttpParser &parser, const HttpSlice &line)
 {
 	// Format: Key: Value
 	// Example: Host: localhost
 
-	size_t colonPos = line.find(':');
-	if (colonPos == std::string::npos)
+	const char *base = parser._buffer.data();
+	const char *start = base + line.offset;
+	size_t colonIdx = HttpScanner::findChar(start, line.length, ':');
+	if (colonIdx == line.length)
 		return false;
-
-	std::string key = trim(line.substr(0, colonPos));
-	std::string value = trim(line.substr(colonPos + 1));
-
-	if (key.empty())
+	const char *colon = start + colonIdx;
+
+	// Trim surrounding whitespace by moving the slice bounds, not by copying
+	size_t keyBegin = line.offset;
+	size_t keyEnd = colon - base;
+	size_t valBegin = keyEnd + 1;
+	size_t valEnd = line.offset + line.length;
+
+	while (keyBegin < keyEnd && std::isspace(static_cast<unsigned char>(base[keyBegin])))
+		keyBegin++;
+	while (keyEnd > keyBegin && std::isspace(static_cast<unsigned char>(base[keyEnd - 1])))
+		keyEnd--;
+	while (valBegin < valEnd && std::isspace(static_cast<unsigned char>(base[valBegin])))
+		valBegin++;
+	while (valEnd > valBegin && std::isspace(static_cast<unsigned char>(base[valEnd - 1])))
+		valEnd--;
+
+	if (keyBegin == keyEnd)
 		return false;
 
+	HttpSlice key(keyBegin, keyEnd - keyBegin);
+	HttpSlice value(valBegin, valEnd - valBegin);
 	parser._request.addHeader(key, value);
-	Logger::debug("Header: " + key + ": " + value);
+
+	if (Logger::isEnabled(Logger::LEVEL_DEBUG))
+		Logger::debug("Header: " + sliceStr(base, key) + ": " + sliceStr(base, value));
 	return true;
 }
 
 size_t ParseHeadersState::getContentLength(HttpParser &parser)
 {
-	std::string clHeader = parser._request.getHeader("Content-Length");
-	if (clHeader.empty())
+	if (!parser._request.hasHeader(HDR_CONTENT_LENGTH))
 		return 0;
 
 	// what we are doing here is converting the Content-Length header value to size_t
-	return static_cast<size_t>(std::strtoul(clHeader.c_str(), NULL, 10));
+	// straight from the buffer; an overflowing value saturates so it trips the 413 check
+	StringView cl = parser._request.getHeader(HDR_CONTENT_LENGTH);
+	return parseDecimal(cl.data(), cl.size());
 }
 
 // ============================================================================
 // ParseBodyState - Parse request body
 // ============================================================================
 
-ParseBodyState::ParseBodyState(size_t contentLength)
-	: _contentLength(contentLength), _bytesRead(0)
+ParseBodyState::ParseBodyState()
+	: _contentLength(0), _bytesRead(0)
+{
+}
+
+void ParseBodyState::begin(size_t contentLength)
 {
-	Logger::debug("ParseBodyState created for body parsing");
+	_contentLength = contentLength;
+	_bytesRead = 0;
 }
 
 // Parses the Http request body incrementally until we reach Content-Length
@@ -194,29 +329,29 @@ void ParseBodyState::parse(HttpParser &parser)
 	// available = 200 bytes                // Only have 200 right now
 	// toRead = min(200, 700) = 200 bytes  // Read what we have (200)
 	size_t remaining = _contentLength - _bytesRead;
-	size_t available = parser._buffer.size();
+	size_t available = parser.available();
 	size_t toRead = (available < remaining) ? available : remaining;
 
 	if (toRead > 0)
 	{
-		// Append to body
-		std::string currentBody = parser._request.getBody();
-		currentBody.append(parser._buffer.substr(0, toRead));
-		parser._request.setBody(currentBody);
-
-		parser._buffer.erase(0, toRead);
+		// Append to body straight from the receive buffer
+		parser._request.appendBody(parser.cursor(), toRead);
+		parser.consumeBody(toRead);
 		_bytesRead += toRead;
 
-		std::ostringstream os;
-		os << "Read " << toRead << " bytes, total: " << _bytesRead << "/" << _contentLength;
-		Logger::debug(os.str());
+		if (Logger::isEnabled(Logger::LEVEL_DEBUG))
+		{
+			std::ostringstream os;
+			os << "Read " << toRead << " bytes, total: " << _bytesRead << "/" << _contentLength;
+			Logger::debug(os.str());
+		}
 	}
 
 	// Check if body is complete
 	if (_bytesRead >= _contentLength)
 	{
 		Logger::debug("Body parsing complete");
-		parser.setState(new ParseCompleteState());
+		parser.setState(&parser._completeState);
 		parser.setComplete();
 	}
 }
@@ -228,7 +363,13 @@ void ParseBodyState::parse(HttpParser &parser)
 ParseChunkedBodyState::ParseChunkedBodyState()
 	: _state(CHUNK_SIZE), _chunkSize(0), _chunkRead(0)
 {
-	Logger::debug("ParseChunkedBodyState created");
+}
+
+void ParseChunkedBodyState::begin()
+{
+	_state = CHUNK_SIZE;
+	_chunkSize = 0;
+	_chunkRead = 0;
 }
 
 void ParseChunkedBodyState::parse(HttpParser &parser)
@@ -237,21 +378,26 @@ void ParseChunkedBodyState::parse(HttpParser &parser)
 	{
 		if (_state == CHUNK_SIZE)
 		{
-			size_t pos = findCRLF(parser._buffer);
-			if (pos == std::string::npos)
+			HttpSlice line;
+			HttpParser::LineStatus status = parser.nextLine(line, parser._maxHeaderLine);
+			if (status == HttpParser::LINE_INCOMPLETE)
 				return; // Need more data for size line
+			if (status == HttpParser::LINE_INVALID || status == HttpParser::LINE_TOO_LONG)
+			{
+				parser.setState(&parser._errorState);
+				parser.setError("Malformed line (control character or bare CR/LF)");
+				return;
+			}
 
-			std::string line = parser._buffer.substr(0, pos);
-			// Parse hex size
-			std::stringstream ss(line);
-			if (!(ss >> std::hex >> _chunkSize))
+			// Parse hex size (chunk extensions after ';' are ignored)
+			if (!parseHex(parser._buffer.data() + line.offset, line.length, _chunkSize))
 			{
-				parser.setState(new ParseErrorState());
-				parser.setError("Invalid chunk size: " + line);
+				parser.setState(&parser._errorState);
+				parser.setError("Invalid chunk size: " + sliceStr(parser._buffer.data(), line));
 				return;
 			}
 
-			parser._buffer.erase(0, pos + 2); // Consume line + CRLF
+			parser.discardFrom(line.offset); // Size line is framing, not content
 
 			if (_chunkSize == 0)
 				_state = CHUNK_TRAILERS;
@@ -271,25 +417,22 @@ void ParseChunkedBodyState::parse(HttpParser &parser)
 				continue;
 			}
 
-			size_t available = parser._buffer.size();
+			size_t available = parser.available();
 			size_t toRead = (available < remaining) ? available : remaining;
 
 			if (toRead == 0)
 				return; // Need data
 
-			std::string currentBody = parser._request.getBody();
 			// Check limits!
-			if (currentBody.size() + toRead > parser.getMaxBodySize())
+			if (parser._request.getBodySize() + toRead > parser.getMaxBodySize())
 			{
-				parser.setState(new ParseErrorState());
+				parser.setState(&parser._errorState);
 				parser.setError("Payload Too Large");
 				return;
 			}
 
-			currentBody.append(parser._buffer.substr(0, toRead));
-			parser._request.setBody(currentBody);
-
-			parser._buffer.erase(0, toRead);
+			parser._request.appendBody(parser.cursor(), toRead);
+			parser.consumeBody(toRead);
 			_chunkRead += toRead;
 
 			if (_chunkRead >= _chunkSize)
@@ -297,33 +440,39 @@ void ParseChunkedBodyState::parse(HttpParser &parser)
 		}
 		else if (_state == CHUNK_DATA_CRLF)
 		{
-			if (parser._buffer.length() < 2)
+			if (parser.available() < 2)
 				return; // Need CRLF
 
-			if (parser._buffer.substr(0, 2) != "\r\n")
+			if (std::memcmp(parser.cursor(), "\r\n", 2) != 0)
 			{
-				parser.setState(new ParseErrorState());
+				parser.setState(&parser._errorState);
 				parser.setError("Invalid chunk terminator");
 				return;
 			}
-			parser._buffer.erase(0, 2);
+			parser.consumeBody(2);
 			_state = CHUNK_SIZE;
 		}
 		else if (_state == CHUNK_TRAILERS)
 		{
 			// Simple: wait for empty line (CRLF) to end message
 			// or consume headers until empty line
-			size_t pos = findCRLF(parser._buffer);
-			if (pos == std::string::npos)
+			HttpSlice line;
+			HttpParser::LineStatus status = parser.nextLine(line, parser._maxHeaderLine);
+			if (status == HttpParser::LINE_INCOMPLETE)
 				return;
+			if (status == HttpParser::LINE_INVALID || status == HttpParser::LINE_TOO_LONG)
+			{
+				parser.setState(&parser._errorState);
+				parser.setError("Malformed line (control character or bare CR/LF)");
+				return;
+			}
 
-			std::string line = parser._buffer.substr(0, pos);
-			parser._buffer.erase(0, pos + 2);
+			parser.discardFrom(line.offset);
 
-			if (line.empty())
+			if (line.length == 0)
 			{
 				Logger::debug("Chunked parsing complete");
-				parser.setState(new ParseCompleteState());
+				parser.setState(&parser._completeState);
 				parser.setComplete();
 				return;
 			}
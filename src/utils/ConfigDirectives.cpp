@@ -180,6 +180,169 @@ bool ConfigDirectives::parseErrorPage(std::vector<Token> &tokens, size_t &pos, S
 	return expectSemicolon(tokens, pos, error);
 }
 
+// large_client_header_buffers <number> <size>;
+// Same meaning as nginx: no request line or header line may exceed <size>,
+// and the whole request head must fit in <number> * <size> bytes
+bool ConfigDirectives::parseLargeClientHeaderBuffers(std::vector<Token> &tokens, size_t &pos, ServerConfig &server, std::string &error)
+{
+	Token directive = advance(tokens, pos); // Consume 'large_client_header_buffers'
+	Token number = advance(tokens, pos);
+	Token size = advance(tokens, pos);
+
+	if (number.type != TOKEN_WORD || size.type != TOKEN_WORD)
+	{
+		setError(error, "Expected 'large_client_header_buffers <number> <size>;'", directive.line);
+		return false;
+	}
+
+	size_t count = std::atol(number.value.c_str());
+	size_t bufferSize = parseSizeString(size.value);
+	if (count == 0 || bufferSize == 0)
+	{
+		setError(error, "Invalid large_client_header_buffers: " + number.value + " " + size.value, directive.line);
+		return false;
+	}
+
+	server.setMaxRequestLine(bufferSize);
+	server.setMaxHeaderLine(bufferSize);
+	server.setMaxHeaderSize(count * bufferSize);
+	return expectSemicolon(tokens, pos, error);
+}
+
+// client_max_request_line <size>; client_max_header_line <size>;
+// client_max_header_count <n>;     client_max_header_size <size>;
+// Fine-grained overrides of the limits set by large_client_header_buffers
+bool ConfigDirectives::parseHeaderLimit(std::vector<Token> &tokens, size_t &pos, ServerConfig &server, std::string &error)
+{
+	Token directive = advance(tokens, pos);
+	Token value = advance(tokens, pos);
+
+	if (value.type != TOKEN_WORD)
+	{
+		setError(error, "Expected value after '" + directive.value + "'", value.line);
+		return false;
+	}
+
+	size_t limit = parseSizeString(value.value);
+	if (limit == 0)
+	{
+		setError(error, "Invalid " + directive.value + ": " + value.value, value.line);
+		return false;
+	}
+
+	if (directive.value == "client_max_request_line")
+		server.setMaxRequestLine(limit);
+	else if (directive.value == "client_max_header_line")
+		server.setMaxHeaderLine(limit);
+	else if (directive.value == "client_max_header_count")
+		server.setMaxHeaderCount(limit);
+	else
+		server.setMaxHeaderSize(limit);
+	return expectSemicolon(tokens, pos, error);
+}
+
+// open_file_cache off;
+// open_file_cache max=<n> [inactive=<time>];
+// Keep up to <n> served paths open with their metadata; close those unused for <time>
+bool ConfigDirectives::parseOpenFileCache(std::vector<Token> &tokens, size_t &pos, ServerConfig &server, std::string &error)
+{
+	Token directive = advance(tokens, pos); // Consume 'open_file_cache'
+
+	if (peek(tokens, pos).type == TOKEN_WORD && peek(tokens, pos).value == "off")
+	{
+		advance(tokens, pos);
+		server.setOpenFileCache(0, OPEN_FILE_CACHE_INACTIVE);
+		return expectSemicolon(tokens, pos, error);
+	}
+
+	size_t maxEntries = 0;
+	time_t inactive = OPEN_FILE_CACHE_INACTIVE;
+	while (peek(tokens, pos).type == TOKEN_WORD)
+	{
+		Token param = advance(tokens, pos);
+		if (param.value.compare(0, 4, "max=") == 0)
+			maxEntries = std::atol(param.value.c_str() + 4);
+		else if (param.value.compare(0, 9, "inactive=") == 0)
+			inactive = parseTimeString(param.value.substr(9));
+		else
+		{
+			setError(error, "Unknown open_file_cache parameter: " + param.value, param.line);
+			return false;
+		}
+	}
+
+	if (maxEntries == 0 || inactive < 0)
+	{
+		setError(error, "Expected 'open_file_cache off;' or 'open_file_cache max=<n> [inactive=<time>];'", directive.line);
+		return false;
+	}
+
+	server.setOpenFileCache(maxEntries, inactive);
+	return expectSemicolon(tokens, pos, error);
+}
+
+// open_file_cache_valid <time>;
+// How long a cached entry is trusted before it is checked against the file again
+bool ConfigDirectives::parseOpenFileCacheValid(std::vector<Token> &tokens, size_t &pos, ServerConfig &server, std::string &error)
+{
+	advance(tokens, pos); // Consume 'open_file_cache_valid'
+	Token value = advance(tokens, pos);
+
+	time_t valid = (value.type == TOKEN_WORD) ? parseTimeString(value.value) : -1;
+	if (valid < 0)
+	{
+		setError(error, "Expected time after 'open_file_cache_valid'", value.line);
+		return false;
+	}
+
+	server.setOpenFileCacheValid(valid);
+	return expectSemicolon(tokens, pos, error);
+}
+
+// open_file_cache_errors on|off;
+// Also cache failed lookups (missing or forbidden files)
+bool ConfigDirectives::parseOpenFileCacheErrors(std::vector<Token> &tokens, size_t &pos, ServerConfig &server, std::string &error)
+{
+	advance(tokens, pos); // Consume 'open_file_cache_errors'
+	Token value = advance(tokens, pos);
+
+	if (value.type != TOKEN_WORD || (value.value != "on" && value.value != "off"))
+	{
+		setError(error, "Expected 'on' or 'off' after 'open_file_cache_errors'", value.line);
+		return false;
+	}
+
+	server.setOpenFileCacheErrors(value.value == "on");
+	return expectSemicolon(tokens, pos, error);
+}
+
+// static_cache <size>|off;  static_cache_max_file <size>;
+// Keep whole responses of files up to static_cache_max_file in memory, within <size> bytes
+bool ConfigDirectives::parseStaticCache(std::vector<Token> &tokens, size_t &pos, ServerConfig &server, std::string &error)
+{
+	Token directive = advance(tokens, pos);
+	Token value = advance(tokens, pos);
+
+	if (value.type != TOKEN_WORD)
+	{
+		setError(error, "Expected size after '" + directive.value + "'", value.line);
+		return false;
+	}
+
+	size_t size = (value.value == "off") ? 0 : parseSizeString(value.value);
+	if (size == 0 && (value.value != "off" || directive.value != "static_cache"))
+	{
+		setError(error, "Invalid " + directive.value + ": " + value.value, value.line);
+		return false;
+	}
+
+	if (directive.value == "static_cache")
+		server.setStaticCacheSize(size);
+	else
+		server.setStaticCacheMaxFile(size);
+	return expectSemicolon(tokens, pos, error);
+}
+
 // ============================================================================
 // Location Directive Parsers
 // ============================================================================
@@ -267,6 +430,193 @@ bool ConfigDirectives::parseAutoindex(std::vector<Token> &tokens, size_t &pos, L
 	location.setAutoindex(enabled);
 	return expectSemicolon(tokens, pos, error);
 }
+// gzip_static on|off;  brotli_static on|off;
+// Serve a precompressed file.gz / file.br next to the requested file when the client accepts it
+bool ConfigDirectives::parseStaticCompression(std::vector<Token> &tokens, size_t &pos, LocationConfig &location, std::string &error)
+{
+	Token directive = advance(tokens, pos);
+	Token value = advance(tokens, pos);
+
+	if (value.type != TOKEN_WORD || (value.value != "on" && value.value != "off"))
+	{
+		setError(error, "Expected 'on' or 'off' after '" + directive.value + "'", value.line);
+		return false;
+	}
+
+	if (directive.value == "gzip_static")
+		location.setGzipStatic(value.value == "on");
+	else
+		location.setBrotliStatic(value.value == "on");
+	return expectSemicolon(tokens, pos, error);
+}
+
+// gzip on|off;  gzip_comp_level 1-9;  gzip_min_length <size>;  gzip_types <mime>... | *;
+bool ConfigDirectives::parseGzip(std::vector<Token> &tokens, size_t &pos, LocationConfig &location, std::string &error)
+{
+	Token directive = advance(tokens, pos);
+
+	if (directive.value == "gzip_types")
+	{
+		if (peek(tokens, pos).type != TOKEN_WORD)
+		{
+			setError(error, "Expected at least one MIME type after 'gzip_types'", directive.line);
+			return false;
+		}
+		while (peek(tokens, pos).type == TOKEN_WORD)
+			location.addGzipType(advance(tokens, pos).value);
+		return expectSemicolon(tokens, pos, error);
+	}
+
+	Token value = advance(tokens, pos);
+	if (value.type != TOKEN_WORD)
+	{
+		setError(error, "Expected a value after '" + directive.value + "'", directive.line);
+		return false;
+	}
+
+	if (directive.value == "gzip")
+	{
+		if (value.value != "on" && value.value != "off")
+		{
+			setError(error, "Expected 'on' or 'off' after 'gzip'", value.line);
+			return false;
+		}
+		location.setGzip(value.value == "on");
+	}
+	else if (directive.value == "gzip_comp_level")
+	{
+		if (value.value.size() != 1 || value.value[0] < '1' || value.value[0] > '9')
+		{
+			setError(error, "gzip_comp_level must be between 1 and 9", value.line);
+			return false;
+		}
+		location.setGzipCompLevel(value.value[0] - '0');
+	}
+	else
+		location.setGzipMinLength(parseSizeString(value.value));
+	return expectSemicolon(tokens, pos, error);
+}
+
+// expires <time> | -<time> | epoch | max | off;
+// Rendered into Cache-Control (and Expires, where it is a fixed date) once, here.
+// A relative time gets max-age only: an Expires date would have to be formatted per request
+bool ConfigDirectives::parseExpires(std::vector<Token> &tokens, size_t &pos, LocationConfig &location, std::string &error)
+{
+	advance(tokens, pos); // Consume 'expires'
+	Token value = advance(tokens, pos);
+
+	if (value.type != TOKEN_WORD)
+	{
+		setError(error, "Expected a time, 'epoch', 'max' or 'off' after 'expires'", value.line);
+		return false;
+	}
+
+	std::vector<ResponseHeader> headers;
+	if (value.value == "epoch")
+	{
+		headers.push_back(ResponseHeader("Expires", "Thu, 01 Jan 1970 00:00:01 GMT", false));
+		headers.push_back(ResponseHeader("Cache-Control", "no-cache", false));
+	}
+	else if (value.value == "max")
+	{
+		headers.push_back(ResponseHeader("Expires", "Thu, 31 Dec 2037 23:55:55 GMT", false));
+		headers.push_back(ResponseHeader("Cache-Control", "max-age=315360000", false));
+	}
+	else if (value.value != "off")
+	{
+		bool negative = value.value[0] == '-';
+		time_t seconds = parseTimeString(negative ? value.value.substr(1) : value.value);
+		if (seconds < 0)
+		{
+			setError(error, "Invalid time '" + value.value + "' for 'expires'", value.line);
+			return false;
+		}
+		if (negative)
+			headers.push_back(ResponseHeader("Cache-Control", "no-cache", false));
+		else
+			headers.push_back(ResponseHeader("Cache-Control", "max-age=" + toString(seconds), false));
+	}
+
+	location.setExpires(headers);
+	return expectSemicolon(tokens, pos, error);
+}
+
+// add_header <name> <value> [always];  (quote values with spaces or commas)
+bool ConfigDirectives::parseAddHeader(std::vector<Token> &tokens, size_t &pos, LocationConfig &location, std::string &error)
+{
+	Token directive = advance(tokens, pos); // Consume 'add_header'
+	Token name = advance(tokens, pos);
+	Token value = advance(tokens, pos);
+
+	if (name.type != TOKEN_WORD || value.type != TOKEN_WORD)
+	{
+		setError(error, "Expected 'add_header <name> <value> [always];'", directive.line);
+		return false;
+	}
+
+	// Header names are tokens: anything else would break the response head
+	for (size_t i = 0; i < name.value.size(); i++)
+	{
+		char c = name.value[i];
+		if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_')
+		{
+			setError(error, "Invalid header name '" + name.value + "'", name.line);
+			return false;
+		}
+	}
+	if (value.value.find_first_of("\r\n") != std::string::npos)
+	{
+		setError(error, "Header value for '" + name.value + "' contains a line break", value.line);
+		return false;
+	}
+
+	bool always = false;
+	if (peek(tokens, pos).type == TOKEN_WORD && peek(tokens, pos).value == "always")
+	{
+		advance(tokens, pos);
+		always = true;
+	}
+
+	location.addResponseHeader(name.value, value.value, always);
+	return expectSemicolon(tokens, pos, error);
+}
+
+// try_files <candidate>... <fallback>;  candidates may use $uri, a trailing '/' asks for a directory
+// The fallback is a URI served from the same location, or =<code> (try_files $uri $uri/ =404;)
+bool ConfigDirectives::parseTryFiles(std::vector<Token> &tokens, size_t &pos, LocationConfig &location, std::string &error)
+{
+	Token directive = advance(tokens, pos); // Consume 'try_files'
+
+	std::vector<std::string> entries;
+	while (peek(tokens, pos).type == TOKEN_WORD)
+		entries.push_back(advance(tokens, pos).value);
+
+	if (entries.size() < 2)
+	{
+		setError(error, "Expected 'try_files <file>... <uri> | =<code>;'", directive.line);
+		return false;
+	}
+
+	const std::string &fallback = entries.back();
+	if (fallback[0] == '=')
+	{
+		int code = std::atoi(fallback.c_str() + 1);
+		if (fallback.find_first_not_of("0123456789", 1) != std::string::npos || code < 100 || code > 599)
+		{
+			setError(error, "Invalid try_files status '" + fallback + "'", directive.line);
+			return false;
+		}
+	}
+	else if (fallback[0] != '/' && fallback.compare(0, 4, "$uri") != 0)
+	{
+		setError(error, "try_files fallback must be a URI or =<code>: " + fallback, directive.line);
+		return false;
+	}
+
+	location.setTryFiles(entries);
+	return expectSemicolon(tokens, pos, error);
+}
+
 bool ConfigDirectives::parseClientMaxBodySize(std::vector<Token> &tokens, size_t &pos, LocationConfig &location, std::string &error)
 {
 	advance(tokens, pos); // Consume 'client_max_body_size'
@@ -1,5 +1,10 @@
 #include "utils/ErrorPageGenerator.hpp"
 
+ErrorPageGenerator::ErrorPageGenerator()
+    : defaultTemplate_(compile(generateDefaultPage()))
+{
+}
+
 ErrorPageGenerator &ErrorPageGenerator::getInstance()
 {
     static ErrorPageGenerator instance;
@@ -9,45 +14,87 @@ ErrorPageGenerator &ErrorPageGenerator::getInstance()
 void ErrorPageGenerator::clearErrorPage(int statusCode)
 {
     errorPages_.erase(statusCode);
+    rendered_.erase(statusCode);
 }
 
 void ErrorPageGenerator::clearAllErrorPages()
 {
     errorPages_.clear();
+    rendered_.clear();
 }
 
-std::string ErrorPageGenerator::getErrorPage(int statusCode, const std::string &reason) const
+const std::string &ErrorPageGenerator::getErrorPage(int statusCode, const std::string &reason) const
 {
-    std::string content;
+    std::map<int, std::pair<std::string, std::string> >::const_iterator cached = rendered_.find(statusCode);
+    if (cached != rendered_.end() && cached->second.first == reason)
+        return cached->second.second;
 
-    // Check if custom error page exists in cache
+    std::ostringstream code;
+    code << statusCode;
+
+    // Placeholders ({STATUS_CODE}, {REASON}) are resolved in custom and default pages alike
+    std::string content;
     std::map<int, std::string>::const_iterator it = errorPages_.find(statusCode);
     if (it != errorPages_.end())
-        content = it->second;
+        content = render(compile(it->second), code.str(), reason);
     else
-        content = generateDefaultPage();
+        content = render(defaultTemplate_, code.str(), reason);
+
+    std::pair<std::string, std::string> &entry = rendered_[statusCode];
+    entry.first = reason;
+    entry.second.swap(content);
+    return entry.second;
+}
 
-    // Replace placeholders: {STATUS_CODE} and {REASON}
-    // We do this for both custom and default pages to ensure consistency
-    std::ostringstream codeStr;
-    codeStr << statusCode;
-    std::string codeS = codeStr.str();
+ErrorPageGenerator::Template ErrorPageGenerator::compile(const std::string &source)
+{
+    static const char *const names[] = {"{STATUS_CODE}", "{REASON}"};
+    static const Placeholder kinds[] = {STATUS_CODE, REASON};
 
-    size_t pos = 0;
-    while ((pos = content.find("{STATUS_CODE}", pos)) != std::string::npos)
+    Template page;
+    size_t start = 0;
+    while (true)
     {
-        content.replace(pos, 13, codeS);
-        pos += codeS.length();
+        // Earliest placeholder from start
+        size_t pos = std::string::npos;
+        size_t which = 0;
+        for (size_t i = 0; i < 2; ++i)
+        {
+            size_t found = source.find(names[i], start);
+            if (found < pos)
+            {
+                pos = found;
+                which = i;
+            }
+        }
+
+        Segment segment;
+        segment.text = source.substr(start, pos == std::string::npos ? std::string::npos : pos - start);
+        segment.next = (pos == std::string::npos) ? NONE : kinds[which];
+        page.push_back(segment);
+        if (pos == std::string::npos)
+            return page;
+        start = pos + std::strlen(names[which]);
     }
+}
 
-    pos = 0;
-    while ((pos = content.find("{REASON}", pos)) != std::string::npos)
+std::string ErrorPageGenerator::render(const Template &page, const std::string &code, const std::string &reason)
+{
+    size_t length = 0;
+    for (Template::const_iterator it = page.begin(); it != page.end(); ++it)
+        length += it->text.size() + (it->next == STATUS_CODE ? code.size() : (it->next == REASON ? reason.size() : 0));
+
+    std::string out;
+    out.reserve(length);
+    for (Template::const_iterator it = page.begin(); it != page.end(); ++it)
     {
-        content.replace(pos, 8, reason);
-        pos += reason.length();
+        out += it->text;
+        if (it->next == STATUS_CODE)
+            out += code;
+        else if (it->next == REASON)
+            out += reason;
     }
-
-    return content;
+    return out;
 }
 
 std::string ErrorPageGenerator::generateDefaultPage() const
@@ -4,42 +4,116 @@ FileHandler::FileHandler() {}
 
 FileHandler::~FileHandler() {}
 
+// Every access goes through RootDirectories: beneath the root's fd when the path has one,
+// then fstat() on what was opened (O_PATH: metadata only, no permission needed)
+bool FileHandler::statPath(const std::string &path, struct stat &st)
+{
+    int fd = RootDirectories::getInstance()->open(path, O_PATH | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    bool ok = fstat(fd, &st) == 0;
+    close(fd);
+    return ok;
+}
+
 bool FileHandler::fileExists(const std::string &path)
 {
     struct stat buffer;
-    return (stat(path.c_str(), &buffer) == 0);
+    return statPath(path, buffer);
 }
 
 bool FileHandler::isDirectory(const std::string &path)
 {
     struct stat buffer;
-    if (stat(path.c_str(), &buffer) != 0)
+    if (!statPath(path, buffer))
         return false;
     return S_ISDIR(buffer.st_mode);
 }
 
 bool FileHandler::isReadable(const std::string &path)
 {
-    std::ifstream file(path.c_str());
-    return file.good();
+    int fd = RootDirectories::getInstance()->open(path, O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+    if (fd < 0)
+        return false;
+    close(fd);
+    return true;
 }
 
 std::string FileHandler::readFile(const std::string &path)
 {
-    std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
-    if (!file)
+    size_t size;
+    int fd = openRegularFile(path, size);
+    if (fd < 0)
         return "";
 
-    std::ostringstream content;
-    content << file.rdbuf();
-    file.close();
-    return content.str();
+    std::string content(size, '\0');
+    size_t done = 0;
+    while (done < size)
+    {
+        ssize_t n = read(fd, &content[done], size - done);
+        if (n <= 0)
+            break;
+        done += n;
+    }
+    close(fd);
+    content.resize(done);
+    return content;
 }
 
 size_t FileHandler::getFileSize(const std::string &path)
 {
     struct stat buffer;
-    if (stat(path.c_str(), &buffer) != 0)
+    if (!statPath(path, buffer))
         return 0;
     return static_cast<size_t>(buffer.st_size);
 }
+
+int FileHandler::openRegularFile(const std::string &path, size_t &size)
+{
+    int fd = RootDirectories::getInstance()->open(path, O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+    if (fd < 0)
+        return -1;
+
+    // Size comes from the open file, so it matches what will be sent even if the path is replaced
+    struct stat buffer;
+    if (fstat(fd, &buffer) != 0 || !S_ISREG(buffer.st_mode))
+    {
+        close(fd);
+        return -1;
+    }
+    size = static_cast<size_t>(buffer.st_size);
+    return fd;
+}
+
+int FileHandler::writeFile(const std::string &path, const std::string &content, bool &created)
+{
+    RootDirectories *roots = RootDirectories::getInstance();
+
+    // Replace an existing file, else create it: which one happened decides 200 / 201
+    created = false;
+    int fd = roots->open(path, O_WRONLY | O_TRUNC | O_CLOEXEC | O_NONBLOCK);
+    if (fd < 0 && errno == ENOENT)
+    {
+        created = true;
+        fd = roots->open(path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    }
+    if (fd < 0)
+        return -1;
+
+    size_t done = 0;
+    while (done < content.size())
+    {
+        ssize_t n = write(fd, content.data() + done, content.size() - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+        {
+            int saved = errno;
+            close(fd);
+            errno = saved;
+            return -1;
+        }
+        done += n;
+    }
+    return close(fd);
+}
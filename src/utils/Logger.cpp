@@ -47,11 +47,45 @@ void Logger::error(const std::string &msg)
 	log(LEVEL_ERROR, msg);
 }
 
+void Logger::debug(const char *msg)
+{
+	if (isEnabled(LEVEL_DEBUG))
+		log(LEVEL_DEBUG, msg);
+}
+
+void Logger::info(const char *msg)
+{
+	if (isEnabled(LEVEL_INFO))
+		log(LEVEL_INFO, msg);
+}
+
+void Logger::warn(const char *msg)
+{
+	if (isEnabled(LEVEL_WARN))
+		log(LEVEL_WARN, msg);
+}
+
+void Logger::error(const char *msg)
+{
+	if (isEnabled(LEVEL_ERROR))
+		log(LEVEL_ERROR, msg);
+}
+
 void Logger::shutdown()
 {
 	log(LEVEL_INFO, "Server shutdown complete");
 }
 
+bool Logger::isEnabled(Logger::Level lvl)
+{
+	return lvl >= s_minLevel;
+}
+
+void Logger::setMinLevel(Logger::Level lvl)
+{
+	s_minLevel = lvl;
+}
+
 void Logger::log(Logger::Level lvl, const std::string &msg)
 {
 	// the minimum log level that should be printed.
@@ -91,6 +125,8 @@ const char *Logger::levelName(Logger::Level lvl)
 		return "[WARN]";
 	case LEVEL_ERROR:
 		return "[ERROR]";
+	case LEVEL_OFF:
+		break;
 	}
 	return "[UNKWN]";
 }
@@ -107,6 +143,8 @@ const char *Logger::levelColor(Logger::Level lvl)
 		return "\033[33m"; // Yellow
 	case LEVEL_ERROR:
 		return "\033[31m"; // Red
+	case LEVEL_OFF:
+		break;
 	}
 	return "\033[0m"; // Reset
 }
@@ -0,0 +1,220 @@
+#include "utils/OpenFileCache.hpp"
+
+OpenFileCache *OpenFileCache::_instance = NULL;
+
+OpenFileCache::OpenFileCache()
+	: _maxEntries(0),
+	  _inactive(OPEN_FILE_CACHE_INACTIVE),
+	  _valid(OPEN_FILE_CACHE_VALID),
+	  _cacheErrors(false),
+	  _compressedBytes(0)
+{
+}
+
+OpenFileCache *OpenFileCache::getInstance()
+{
+	if (!_instance)
+		_instance = new OpenFileCache();
+	return _instance;
+}
+
+void OpenFileCache::configure(size_t maxEntries, time_t inactive, time_t valid, bool cacheErrors)
+{
+	clear();
+	_maxEntries = maxEntries;
+	_inactive = inactive;
+	_valid = valid;
+	_cacheErrors = cacheErrors;
+}
+
+bool OpenFileCache::isEnabled() const
+{
+	return _maxEntries > 0;
+}
+
+bool OpenFileCache::lookup(const std::string &path, FileInfo &info)
+{
+	if (!isEnabled())
+	{
+		load(path, info, false);
+		return info.error == 0;
+	}
+
+	time_t now = time(NULL);
+	std::map<std::string, EntryList::iterator>::iterator found = _index.find(path);
+	if (found != _index.end())
+	{
+		EntryList::iterator it = found->second;
+		bool fresh = now - it->validated < _valid;
+		if (!fresh && isUnchanged(*it))
+		{
+			it->validated = now;
+			fresh = true;
+		}
+		if (fresh)
+		{
+			it->lastUsed = now;
+			_entries.splice(_entries.begin(), _entries, it); // Move to front (LRU)
+			info = it->info;
+			return info.error == 0;
+		}
+		Logger::debug("Open file cache: " + path + " changed, reloading");
+		evict(it);
+	}
+
+	load(path, info, true);
+	if (info.error != 0 && (!_cacheErrors || !isCacheableError(info.error)))
+		return false;
+
+	if (_entries.size() >= _maxEntries)
+		evict(--_entries.end());
+
+	Entry entry;
+	entry.path = path;
+	entry.info = info;
+	entry.validated = now;
+	entry.lastUsed = now;
+	entry.compressedLevel = 0;
+	_entries.push_front(entry);
+	_index[path] = _entries.begin();
+	return info.error == 0;
+}
+
+int OpenFileCache::acquire(const std::string &path, FileInfo &info)
+{
+	// Own fd on the same open file: no path resolution, and eviction can't close it under a sender.
+	// F_DUPFD_CLOEXEC keeps it out of CGI children (plain dup() would drop the flag)
+	if (info.fd != -1)
+		return fcntl(info.fd, F_DUPFD_CLOEXEC, 0);
+	return FileHandler::openRegularFile(path, info.size);
+}
+
+bool OpenFileCache::getCompressed(const std::string &path, const FileInfo &info, int level, std::string &out)
+{
+	std::map<std::string, EntryList::iterator>::iterator found = _index.find(path);
+	if (found == _index.end())
+		return false;
+
+	const Entry &entry = *found->second;
+	if (entry.compressed.empty() || entry.compressedLevel != level || !isSameFile(entry.info, info))
+		return false;
+	out = entry.compressed;
+	return true;
+}
+
+void OpenFileCache::storeCompressed(const std::string &path, const FileInfo &info, int level, const std::string &data)
+{
+	std::map<std::string, EntryList::iterator>::iterator found = _index.find(path);
+	if (found == _index.end())
+		return;
+
+	// The file may have been replaced while it was being compressed
+	Entry &entry = *found->second;
+	if (!isSameFile(entry.info, info))
+		return;
+	if (_compressedBytes - entry.compressed.size() + data.size() > GZIP_CACHE_BUDGET)
+		return;
+
+	_compressedBytes -= entry.compressed.size();
+	entry.compressed = data;
+	entry.compressedLevel = level;
+	_compressedBytes += data.size();
+}
+
+void OpenFileCache::invalidate(const std::string &path)
+{
+	std::map<std::string, EntryList::iterator>::iterator found = _index.find(path);
+	if (found != _index.end())
+		evict(found->second);
+}
+
+void OpenFileCache::expireInactive(time_t now)
+{
+	// Least recently used entries are at the back
+	while (!_entries.empty() && now - _entries.back().lastUsed >= _inactive)
+		evict(--_entries.end());
+}
+
+void OpenFileCache::clear()
+{
+	while (!_entries.empty())
+		evict(_entries.begin());
+}
+
+// One open + fstat: existence, permission and metadata all come from the same file
+// (opened beneath its root's directory fd, see RootDirectories)
+void OpenFileCache::load(const std::string &path, FileInfo &info, bool keepOpen)
+{
+	info = FileInfo();
+
+	// O_NONBLOCK: opening a FIFO must not stall the event loop
+	int fd = RootDirectories::getInstance()->open(path, O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+	if (fd < 0)
+	{
+		info.error = errno;
+		return;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		info.error = errno;
+		close(fd);
+		return;
+	}
+
+	if (!S_ISREG(st.st_mode) && !S_ISDIR(st.st_mode))
+	{
+		info.error = EACCES; // Devices, FIFOs, sockets are never served
+		close(fd);
+		return;
+	}
+
+	info.isDirectory = S_ISDIR(st.st_mode);
+	info.size = static_cast<size_t>(st.st_size);
+	info.mtime = st.st_mtime;
+	info.inode = st.st_ino;
+	info.mimeType = MimeTypes::getMimeType(path);
+
+	if (keepOpen && !info.isDirectory)
+		info.fd = fd;
+	else
+		close(fd);
+}
+
+// Only answers that depend on the file tree, not on transient resource limits (EMFILE, ENOMEM)
+bool OpenFileCache::isCacheableError(int error)
+{
+	return error == ENOENT || error == ENOTDIR || error == EACCES || error == ENAMETOOLONG;
+}
+
+bool OpenFileCache::isUnchanged(const Entry &entry) const
+{
+	if (entry.info.error != 0)
+		return false; // Negative entries are simply retried
+
+	// O_PATH: the path is resolved (beneath its root) but nothing is really opened
+	int fd = RootDirectories::getInstance()->open(entry.path, O_PATH | O_CLOEXEC);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	bool ok = fstat(fd, &st) == 0;
+	close(fd);
+	return ok && st.st_ino == entry.info.inode && st.st_mtime == entry.info.mtime &&
+		   static_cast<size_t>(st.st_size) == entry.info.size &&
+		   S_ISDIR(st.st_mode) == entry.info.isDirectory;
+}
+
+bool OpenFileCache::isSameFile(const FileInfo &a, const FileInfo &b)
+{
+	return a.error == 0 && b.error == 0 && a.inode == b.inode && a.mtime == b.mtime && a.size == b.size;
+}
+
+void OpenFileCache::evict(EntryList::iterator it)
+{
+	_compressedBytes -= it->compressed.size();
+	if (it->info.fd != -1)
+		close(it->info.fd);
+	_index.erase(it->path);
+	_entries.erase(it);
+}
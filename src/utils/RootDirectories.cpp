@@ -0,0 +1,172 @@
+#include "utils/RootDirectories.hpp"
+
+RootDirectories *RootDirectories::_instance = NULL;
+
+// Settled once, on the loop thread: the workers resolving paths only ever read it
+RootDirectories::RootDirectories()
+	: _hasOpenat2(probeOpenat2())
+{
+	if (!_hasOpenat2)
+		Logger::warn("openat2 unavailable: paths are checked for '..' and opened with openat()");
+}
+
+RootDirectories *RootDirectories::getInstance()
+{
+	if (!_instance)
+		_instance = new RootDirectories();
+	return _instance;
+}
+
+bool RootDirectories::add(const std::string &dir)
+{
+	std::string path = dir;
+	while (path.size() > 1 && path[path.size() - 1] == '/')
+		path.erase(path.size() - 1);
+	if (path.empty())
+		return false;
+
+	for (size_t i = 0; i < _roots.size(); ++i)
+	{
+		if (_roots[i].path == path)
+			return true;
+	}
+
+	int fd = ::open(path.c_str(), O_PATH | O_DIRECTORY | O_CLOEXEC);
+	if (fd < 0)
+	{
+		Logger::warn(Logger::errnoMsg("Cannot open root directory " + path));
+		return false;
+	}
+
+	Root root;
+	root.path = path;
+	root.fd = fd;
+	std::vector<Root>::iterator it = _roots.begin();
+	while (it != _roots.end() && it->path.size() >= path.size())
+		++it;
+	_roots.insert(it, root);
+	Logger::debug("Root directory opened: " + path);
+	return true;
+}
+
+int RootDirectories::open(const std::string &path, int flags, mode_t mode)
+{
+	const char *relative;
+	const Root *root = find(path, relative);
+	if (!root)
+		return ::open(path.c_str(), flags, mode);
+	return openBeneath(root->fd, relative, flags, mode);
+}
+
+// The parent is resolved beneath the root, the last component is removed relative to it
+int RootDirectories::remove(const std::string &path)
+{
+	const char *relative;
+	const Root *root = find(path, relative);
+	if (!root)
+		return ::remove(path.c_str());
+
+	std::string parent(relative);
+	std::string name = parent;
+	size_t slash = parent.rfind('/');
+	if (slash == std::string::npos)
+		parent = ".";
+	else
+	{
+		name = parent.substr(slash + 1);
+		parent.erase(slash);
+	}
+	if (name.empty() || name == "." || name == "..")
+	{
+		errno = EACCES;
+		return -1;
+	}
+
+	int dirFd = openBeneath(root->fd, parent.c_str(), O_PATH | O_DIRECTORY | O_CLOEXEC, 0);
+	if (dirFd < 0)
+		return -1;
+	int ret = unlinkat(dirFd, name.c_str(), 0);
+	if (ret != 0 && errno == EISDIR)
+		ret = unlinkat(dirFd, name.c_str(), AT_REMOVEDIR); // remove(3) takes empty directories too
+	int saved = errno;
+	close(dirFd);
+	errno = saved;
+	return ret;
+}
+
+void RootDirectories::clear()
+{
+	for (size_t i = 0; i < _roots.size(); ++i)
+		close(_roots[i].fd);
+	_roots.clear();
+}
+
+// The root path is a whole-component prefix of path; relative is what follows it (never empty)
+const RootDirectories::Root *RootDirectories::find(const std::string &path, const char *&relative) const
+{
+	for (size_t i = 0; i < _roots.size(); ++i)
+	{
+		const std::string &root = _roots[i].path;
+		if (path.compare(0, root.size(), root) != 0)
+			continue;
+		if (root != "/" && path.size() > root.size() && path[root.size()] != '/')
+			continue;
+
+		relative = path.c_str() + root.size();
+		while (*relative == '/')
+			++relative;
+		if (*relative == '\0')
+			relative = ".";
+		return &_roots[i];
+	}
+	return NULL;
+}
+
+int RootDirectories::openBeneath(int dirFd, const char *relative, int flags, mode_t mode) const
+{
+	int fd = -1;
+	if (_hasOpenat2)
+	{
+		struct open_how how;
+		std::memset(&how, 0, sizeof(how));
+		how.flags = static_cast<unsigned long long>(flags);
+		how.mode = (flags & O_CREAT) ? mode : 0;
+		how.resolve = RESOLVE_BENEATH | RESOLVE_NO_SYMLINKS;
+		fd = static_cast<int>(syscall(SYS_openat2, dirFd, relative, &how, sizeof(how)));
+		if (fd < 0 && errno == EXDEV)
+			errno = ENOENT; // Outside the root: as if it didn't exist
+		else if (fd < 0 && errno == ELOOP)
+			errno = EACCES; // A symlink on the way
+		return fd;
+	}
+
+	// Fallback: no ".." component, and the last one is not followed
+	for (const char *p = relative; *p; )
+	{
+		const char *end = std::strchr(p, '/');
+		size_t length = end ? static_cast<size_t>(end - p) : std::strlen(p);
+		if (length == 2 && p[0] == '.' && p[1] == '.')
+		{
+			errno = ENOENT;
+			return -1;
+		}
+		p += length;
+		while (*p == '/')
+			++p;
+	}
+	fd = openat(dirFd, relative, flags | O_NOFOLLOW, mode);
+	if (fd < 0 && errno == ELOOP)
+		errno = EACCES;
+	return fd;
+}
+
+bool RootDirectories::probeOpenat2()
+{
+	struct open_how how;
+	std::memset(&how, 0, sizeof(how));
+	how.flags = O_PATH | O_DIRECTORY | O_CLOEXEC;
+	int fd = static_cast<int>(syscall(SYS_openat2, AT_FDCWD, "/", &how, sizeof(how)));
+	if (fd >= 0)
+		close(fd);
+	return fd >= 0 || errno != ENOSYS;
+}
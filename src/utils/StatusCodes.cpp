@@ -25,6 +25,6 @@ void StatusCodes::clearAllErrorPages()
 
 HttpResponse StatusCodes::createErrorResponse(int code, const std::string &reason)
 {
-    std::string body = ErrorPageGenerator::getInstance().getErrorPage(code, reason);
+    const std::string &body = ErrorPageGenerator::getInstance().getErrorPage(code, reason);
     return buildResponse(code, reason, body);
 }
\ No newline at end of file
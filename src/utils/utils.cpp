@@ -1,5 +1,8 @@
 #include "utils/utils.hpp"
+#include "http/HttpScanner.hpp"
 #include <cstdlib>
+#include <cstring>
+#include <iomanip>
 
 // ============================================================================
 // Webserv Startup Print
@@ -36,7 +39,11 @@ std::string trim(const std::string &str)
 // Find the position of the first occurrence of CRLF ("\r\n") starting from 'start'
 size_t findCRLF(const std::string &str, size_t start)
 {
-	return str.find("\r\n", start);
+	if (start >= str.size())
+		return std::string::npos;
+	size_t length = str.size() - start;
+	size_t idx = HttpScanner::findCRLF(str.data() + start, length);
+	return (idx == length) ? std::string::npos : start + idx;
 }
 
 // ============================================================================
@@ -76,7 +83,11 @@ void skipComment(const std::string &input, size_t &pos)
 bool isWordChar(char c)
 {
 	return std::isalnum(static_cast<unsigned char>(c)) ||
-		   c == '-' || c == '_' || c == '.' || c == '/' || c == ':';
+		   c == '-' || c == '_' || c == '.' || c == '/' || c == ':' ||
+		   c == '=' || // key=value parameters (open_file_cache max=1000)
+		   c == '+' || c == '*' || // MIME types (gzip_types image/svg+xml, gzip_types *)
+		   c == '~' || c == '^' || c == '$' || c == '\\' || c == '(' || c == ')' || c == '|' || c == '[' ||
+		   c == ']' || c == '?'; // Location modifiers and regexes (location ~* \.(png|jpe?g)$)
 }
 
 // Parse size string with optional suffix (k/K, m/M, g/G)
@@ -112,50 +123,231 @@ size_t parseSizeString(const std::string &str)
 	return number;
 }
 
+// "30", "30s", "5m", "1h", "1d", "1w", "1y" -> seconds; -1 if malformed
+time_t parseTimeString(const std::string &str)
+{
+	size_t i = 0;
+	while (i < str.length() && std::isdigit(str[i]))
+		i++;
+
+	if (i == 0 || i + 1 < str.length())
+		return -1;
+
+	time_t number = std::atol(str.substr(0, i).c_str());
+	if (i == str.length())
+		return number;
+
+	char suffix = std::tolower(str[i]);
+	if (suffix == 's')
+		return number;
+	else if (suffix == 'm')
+		return number * 60;
+	else if (suffix == 'h')
+		return number * 3600;
+	else if (suffix == 'd')
+		return number * 86400;
+	else if (suffix == 'w')
+		return number * 604800;
+	else if (suffix == 'y')
+		return number * 31536000;
+	return -1;
+}
+
 // ============================================================================
 // HTTP Utilities
 // ============================================================================
 
+// Hex digit value of every byte, -1 if it is not a hex digit
+// (shared by chunk sizes and percent-decoding so neither branches per character class)
+static const signed char kHexValue[256] = {
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+		-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+// IMF-fixdate, the only HTTP-date form a server sends: "Sun, 06 Nov 1994 08:49:37 GMT"
+std::string formatHttpDate(time_t t)
+{
+	static const char *const days[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+	static const char *const months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+										 "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+	struct tm tm;
+	gmtime_r(&t, &tm);
+
+	// Day and month names are fixed by the grammar: no strftime(), whose %a/%b follow the locale
+	std::ostringstream os;
+	os << std::setfill('0') << days[tm.tm_wday] << ", " << std::setw(2) << tm.tm_mday << " " << months[tm.tm_mon]
+	   << " " << std::setw(4) << tm.tm_year + 1900 << " " << std::setw(2) << tm.tm_hour << ":" << std::setw(2)
+	   << tm.tm_min << ":" << std::setw(2) << tm.tm_sec << " GMT";
+	return os.str();
+}
+
+// Any of the three HTTP-date forms a recipient must accept (RFC 9110 5.6.7):
+// IMF-fixdate, obsolete RFC 850 and asctime(); always GMT
+bool parseHttpDate(const StringView &str, time_t &out)
+{
+	static const char *const formats[] = {"%a, %d %b %Y %H:%M:%S GMT", "%A, %d-%b-%y %H:%M:%S GMT",
+										  "%a %b %e %H:%M:%S %Y"};
+	std::string value = str.str();
+	for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
+	{
+		struct tm tm;
+		std::memset(&tm, 0, sizeof(tm));
+		const char *end = strptime(value.c_str(), formats[i], &tm);
+		if (end && *end == '\0')
+		{
+			out = timegm(&tm);
+			return out != static_cast<time_t>(-1);
+		}
+	}
+	return false;
+}
+
+static inline int hexValue(char c)
+{
+	return kHexValue[static_cast<unsigned char>(c)];
+}
+
 HttpMethod stringToHttpMethod(const std::string &method)
 {
-	if (method == "GET")
-		return HTTP_GET;
-	if (method == "POST")
-		return HTTP_POST;
-	if (method == "DELETE")
-		return HTTP_DELETE;
-	if (method == "PUT")
-		return HTTP_PUT;
-	if (method == "HEAD")
-		return HTTP_HEAD;
+	return stringToHttpMethod(method.data(), method.size());
+}
+
+// Match a method token in place (no std::string needed)
+HttpMethod stringToHttpMethod(const char *method, size_t length)
+{
+	switch (length)
+	{
+	case 3:
+		if (std::memcmp(method, "GET", 3) == 0)
+			return HTTP_GET;
+		if (std::memcmp(method, "PUT", 3) == 0)
+			return HTTP_PUT;
+		break;
+	case 4:
+		if (std::memcmp(method, "POST", 4) == 0)
+			return HTTP_POST;
+		if (std::memcmp(method, "HEAD", 4) == 0)
+			return HTTP_HEAD;
+		break;
+	case 6:
+		if (std::memcmp(method, "DELETE", 6) == 0)
+			return HTTP_DELETE;
+		break;
+	}
 	return HTTP_UNKNOWN;
 }
 
-// ============================================================================
-// APP Utilities
-// ============================================================================
+// Parse leading decimal digits (after optional whitespace), like strtoul
+// Saturates at the max size_t value instead of wrapping
+size_t parseDecimal(const char *str, size_t length)
+{
+	size_t i = 0;
+	while (i < length && std::isspace(static_cast<unsigned char>(str[i])))
+		i++;
+
+	size_t value = 0;
+	for (; i < length && str[i] >= '0' && str[i] <= '9'; i++)
+	{
+		size_t digit = static_cast<size_t>(str[i] - '0');
+		if (value > (static_cast<size_t>(-1) - digit) / 10)
+			return static_cast<size_t>(-1);
+		value = value * 10 + digit;
+	}
+	return value;
+}
 
-std::string buildFilePath(const std::string &uri, const std::string &rootDir, const std::string &defaultIndex)
+// Parse a hex number (chunk size); fails if there is no hex digit at all
+bool parseHex(const char *str, size_t length, size_t &out)
 {
-	std::string filePath = rootDir;
+	size_t i = 0;
+	while (i < length && std::isspace(static_cast<unsigned char>(str[i])))
+		i++;
 
-	if (uri == "/" || uri.empty())
-		filePath += "/" + defaultIndex;
-	else
+	size_t value = 0;
+	size_t digits = 0;
+	for (; i < length && hexValue(str[i]) >= 0; i++, digits++)
 	{
-		filePath += uri;
+		if (value > (static_cast<size_t>(-1) >> 4))
+			return false;
+		value = (value << 4) | static_cast<size_t>(hexValue(str[i]));
+	}
+	if (digits == 0)
+		return false;
+	out = value;
+	return true;
+}
 
-		if (FileHandler::isDirectory(filePath))
+// Substring search over a non NUL-terminated range
+bool sliceContains(const char *str, size_t length, const char *needle)
+{
+	size_t n = std::strlen(needle);
+	if (n == 0)
+		return true;
+	for (size_t i = 0; i + n <= length; i++)
+	{
+		if (std::memcmp(str + i, needle, n) == 0)
+			return true;
+	}
+	return false;
+}
+
+// Percent-decode `length` bytes from src into dst ("%41" -> 'A', and '+' -> ' '
+// for form/query data). dst may equal src: output never runs ahead of input,
+// so decoding in place needs no extra buffer. Fails on a truncated or non-hex escape.
+bool percentDecode(const char *src, size_t length, char *dst, size_t &outLength, bool plusAsSpace)
+{
+	size_t w = 0;
+	for (size_t r = 0; r < length; r++)
+	{
+		char c = src[r];
+		if (c == '%')
 		{
-			if (filePath[filePath.length() - 1] != '/')
-				filePath += "/";
-			filePath += defaultIndex;
+			if (r + 2 >= length)
+				return false;
+			int hi = hexValue(src[r + 1]);
+			int lo = hexValue(src[r + 2]);
+			if (hi < 0 || lo < 0)
+				return false;
+			c = static_cast<char>((hi << 4) | lo);
+			r += 2;
 		}
+		else if (c == '+' && plusAsSpace)
+			c = ' ';
+		dst[w++] = c;
 	}
+	outLength = w;
+	return true;
+}
 
-	return filePath;
+// Decode into a std::string (form fields and other small values)
+std::string percentDecode(const StringView &str, bool plusAsSpace)
+{
+	std::string out(str.data(), str.size());
+	size_t length = 0;
+	if (out.empty() || !percentDecode(out.data(), out.size(), &out[0], length, plusAsSpace))
+		return out; // Malformed escapes are kept as sent
+	out.resize(length);
+	return out;
 }
 
+// ============================================================================
+// APP Utilities
+// ============================================================================
+
 // ============================================================================
 // Memory Utilities
 // ============================================================================
@@ -168,3 +360,58 @@ void freeArray(char **array)
 		delete[] array[i];
 	delete[] array;
 }
+
+// Accept-Encoding negotiation: is coding (e.g. "gzip") acceptable?
+// An explicit entry wins over "*"; q=0 means "not acceptable" (RFC 9110 12.5.3)
+bool acceptsEncoding(const StringView &acceptEncoding, const char *coding)
+{
+	StringView wanted(coding);
+	int explicitMatch = -1; // -1 unseen, 0 refused, 1 accepted
+	int wildcard = -1;
+
+	size_t pos = 0;
+	while (pos < acceptEncoding.size())
+	{
+		size_t end = acceptEncoding.find(',', pos);
+		if (end == StringView::npos)
+			end = acceptEncoding.size();
+		StringView item = acceptEncoding.substr(pos, end - pos);
+		pos = end + 1;
+
+		// token [ OWS ";" OWS "q=" qvalue ]
+		size_t i = 0;
+		while (i < item.size() && (item[i] == ' ' || item[i] == '\t'))
+			i++;
+		size_t start = i;
+		while (i < item.size() && item[i] != ';' && item[i] != ' ' && item[i] != '\t')
+			i++;
+		StringView token = item.substr(start, i - start);
+		if (token.empty())
+			continue;
+
+		bool accepted = true;
+		size_t q = item.find("q=", i);
+		if (q != StringView::npos)
+		{
+			// "0", "0.", "0.0", "0.000" are zero, anything else is a positive weight
+			accepted = false;
+			for (size_t j = q + 2; j < item.size() && item[j] != ' ' && item[j] != '\t'; j++)
+			{
+				if (item[j] != '0' && item[j] != '.')
+				{
+					accepted = true;
+					break;
+				}
+			}
+		}
+
+		if (token.iequals(wanted) || (wanted == "gzip" && token.iequals("x-gzip")))
+			explicitMatch = accepted ? 1 : 0;
+		else if (token == "*")
+			wildcard = accepted ? 1 : 0;
+	}
+
+	if (explicitMatch != -1)
+		return explicitMatch == 1;
+	return wildcard == 1;
+}